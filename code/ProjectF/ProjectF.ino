@@ -85,8 +85,8 @@ int main( void )
 
   vSchedulerInit();
 
-  vSchedulerPeriodicTaskCreate(testFunc1, "T1", configMINIMAL_STACK_SIZE, &c1, 0, &xHandle1, pdMS_TO_TICKS(0), pdMS_TO_TICKS(2000), pdMS_TO_TICKS(450), pdMS_TO_TICKS(2000));
-  vSchedulerPeriodicTaskCreate(testFunc2, "T2", configMINIMAL_STACK_SIZE, &c2, 1, &xHandle2, pdMS_TO_TICKS(100), pdMS_TO_TICKS(4000), pdMS_TO_TICKS(450), pdMS_TO_TICKS(1000));
+  xSchedulerPeriodicTaskCreate(testFunc1, "T1", configMINIMAL_STACK_SIZE, &c1, 0, &xHandle1, pdMS_TO_TICKS(0), pdMS_TO_TICKS(2000), pdMS_TO_TICKS(450), pdMS_TO_TICKS(2000), schedMISS_POLICY_ABORT_JOB);
+  xSchedulerPeriodicTaskCreate(testFunc2, "T2", configMINIMAL_STACK_SIZE, &c2, 1, &xHandle2, pdMS_TO_TICKS(100), pdMS_TO_TICKS(4000), pdMS_TO_TICKS(450), pdMS_TO_TICKS(1000), schedMISS_POLICY_ABORT_JOB);
   
   vSchedulerAperiodicTaskCreate( testFuncA1, "A1", "A1-1", pdMS_TO_TICKS(450), pdMS_TO_TICKS(0) );
   vSchedulerAperiodicTaskCreate( testFuncA2, "A2", "A2-1", pdMS_TO_TICKS(450), pdMS_TO_TICKS(50) );
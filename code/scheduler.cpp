@@ -2,12 +2,121 @@
 
 #define schedUSE_TCB_ARRAY 1
 
+#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF && schedUSE_SCHEDULER_TASK == 0 )
+	#error "EDF scheduling policy requires schedUSE_SCHEDULER_TASK"
+#endif /* schedSCHEDULING_POLICY_EDF */
+
+#if( schedUSE_POLLING_SERVER == 1 && ( schedUSE_DEFERRABLE_SERVER + schedUSE_SPORADIC_SERVER + schedUSE_TOTAL_BANDWIDTH_SERVER ) > 1 )
+	#error "Select at most one of schedUSE_DEFERRABLE_SERVER, schedUSE_SPORADIC_SERVER and schedUSE_TOTAL_BANDWIDTH_SERVER"
+#endif
+
+#if( schedUSE_POLLING_SERVER == 1 && schedUSE_TOTAL_BANDWIDTH_SERVER == 1 && ( schedSCHEDULING_POLICY != schedSCHEDULING_POLICY_EDF || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 0 ) )
+	#error "Total Bandwidth Server requires EDF and schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME"
+#endif
+
+#if( schedUSE_APERIODIC_JOBS == 1 && ( ( schedAPERIODIC_ISR_QUEUE_LENGTH & ( schedAPERIODIC_ISR_QUEUE_LENGTH - 1 ) ) != 0 || schedAPERIODIC_ISR_QUEUE_LENGTH > 128 ) )
+	#error "schedAPERIODIC_ISR_QUEUE_LENGTH must be a power of two, at most 128"
+#endif
+
+#if( schedUSE_APERIODIC_JOBS == 1 && schedUSE_APERIODIC_WORKER_TASK == 1 && ( schedUSE_POLLING_SERVER == 0 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 0 ) )
+	#error "Aperiodic worker task requires the Polling Server and schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME"
+#endif
+
+#if( schedUSE_TRACE_BUFFER == 1 && ( ( schedTRACE_BUFFER_LENGTH & ( schedTRACE_BUFFER_LENGTH - 1 ) ) != 0 || schedTRACE_BUFFER_LENGTH > 128 ) )
+	#error "schedTRACE_BUFFER_LENGTH must be a power of two, at most 128"
+#endif
+
+#if( schedUSE_PRECISE_EXECUTION_TIME == 1 && schedUSE_POLLING_SERVER == 1 && ( schedUSE_SPORADIC_SERVER == 1 || schedUSE_TOTAL_BANDWIDTH_SERVER == 1 ) )
+	#error "schedUSE_PRECISE_EXECUTION_TIME is not supported by the Sporadic Server and the Total Bandwidth Server"
+#endif
+
+#if( schedUSE_STACK_PROFILING == 1 && INCLUDE_uxTaskGetStackHighWaterMark2 != 1 )
+	#error "schedUSE_STACK_PROFILING requires INCLUDE_uxTaskGetStackHighWaterMark2"
+#endif
+
+#if( schedUSE_STATIC_ALLOCATION == 1 && configSUPPORT_STATIC_ALLOCATION != 1 )
+	#error "schedUSE_STATIC_ALLOCATION requires configSUPPORT_STATIC_ALLOCATION"
+#endif
+
+#if( schedUSE_MODES == 1 && schedUSE_SCHEDULER_TASK == 0 )
+	#error "schedUSE_MODES requires schedUSE_SCHEDULER_TASK"
+#endif
+
+#if( schedUSE_POLLING_SERVER == 1 && ( schedMAX_NUMBER_OF_SERVERS < 1 || schedMAX_NUMBER_OF_SERVERS > schedMAX_NUMBER_OF_PERIODIC_TASKS ) )
+	#error "schedMAX_NUMBER_OF_SERVERS must be at least 1 and at most schedMAX_NUMBER_OF_PERIODIC_TASKS"
+#endif
+
+#if( schedUSE_POLLING_SERVER == 1 && schedUSE_TOTAL_BANDWIDTH_SERVER == 1 && schedMAX_NUMBER_OF_SERVERS > 1 )
+	#error "Total Bandwidth Server supports a single server"
+#endif
+
+#if( schedUSE_RESOURCES == 1 && schedSCHEDULING_POLICY != schedSCHEDULING_POLICY_RMS && schedSCHEDULING_POLICY != schedSCHEDULING_POLICY_DMS )
+	#error "schedUSE_RESOURCES requires RMS or DMS"
+#endif
+
+#if( schedUSE_RESOURCES == 1 && ( schedMAX_NUMBER_OF_RESOURCES < 1 || schedMAX_NUMBER_OF_RESOURCES > 8 ) )
+	#error "schedMAX_NUMBER_OF_RESOURCES must be at least 1 and at most 8"
+#endif
+
+/* pdTRUE if the server serves jobs as soon as they are released instead of
+ * polling the queue once per period. */
+#define schedSERVER_IS_EVENT_DRIVEN ( schedUSE_POLLING_SERVER == 1 && ( schedUSE_DEFERRABLE_SERVER == 1 || schedUSE_SPORADIC_SERVER == 1 || schedUSE_TOTAL_BANDWIDTH_SERVER == 1 ) )
+
+#if( schedUSE_POLLING_SERVER == 1 && schedUSE_SPORADIC_SERVER == 1 && schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 0 )
+	#error "Sporadic Server requires schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME"
+#endif
+
+/* Called synchronously for every scheduler event, also from the tick hook.
+ * Can be defined in FreeRTOSConfig.h to feed events to an external tool. */
+#ifndef schedTRACE_EVENT_HOOK
+	#define schedTRACE_EVENT_HOOK( ucEvent, pcName, xTick ) ( ( void ) ( xTick ) )
+#endif
+
+/* Signed difference of two tick counts. Its sign orders the two correctly
+ * across a wrap of the tick count as long as they are less than half the
+ * tick range apart. A plain signed cast is only 16 bits wide on AVR. */
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef int16_t SchedTickDiff_t;
+#else
+	typedef int32_t SchedTickDiff_t;
+#endif /* configUSE_16_BIT_TICKS */
+static_assert( sizeof( SchedTickDiff_t ) == sizeof( TickType_t ), "configUSE_16_BIT_TICKS does not match TickType_t" );
+
+/* pdTRUE if the background service runs jobs on the slack of the periodic
+ * tasks. */
+#define schedBACKGROUND_STEALS_SLACK ( schedUSE_POLLING_SERVER == 1 && schedUSE_BACKGROUND_SERVICE == 1 && schedUSE_SLACK_STEALING == 1 )
+
+#if( schedBACKGROUND_STEALS_SLACK && ( schedUSE_SCHEDULER_TASK == 0 || schedUSE_RESPONSE_TIME_ANALYSIS == 0 ) )
+	#error "schedUSE_SLACK_STEALING requires schedUSE_SCHEDULER_TASK and schedUSE_RESPONSE_TIME_ANALYSIS"
+#endif
+
+#if( schedUSE_TASK_STATISTICS == 1 )
+	/* Statistics as they are collected. The means are computed from the sums
+	 * when the statistics are queried. */
+	typedef struct xStatsCollector
+	{
+		SchedTaskStats_t xStats;
+		uint64_t ullExecTimeSum;
+		uint64_t ullResponseTimeSum;
+	} StatsCollector_t;
+#endif /* schedUSE_TASK_STATISTICS */
+
+#if( schedUSE_MODES == 1 )
+	/* Parameters of a periodic task in one mode. */
+	typedef struct xModeParams
+	{
+		TickType_t xPeriod;				/* 0 if the task is not part of the mode. */
+		TickType_t xMaxExecTime;
+		TickType_t xRelativeDeadline;
+	} ModeParams_t;
+#endif /* schedUSE_MODES */
+
 /* Extended Task control block for managing periodic tasks within this library. */
 typedef struct xExtended_TCB
 {
 	TaskFunction_t pvTaskCode; 		/* Function pointer to the code that will be run periodically. */
 	const char *pcName; 			/* Name of the task. */
-	UBaseType_t uxStackDepth; 			/* Stack size of the task. */
+	configSTACK_DEPTH_TYPE usStackDepth;	/* Stack size of the task in words. */
 	void *pvParameters; 			/* Parameters to the task function. */
 	UBaseType_t uxPriority; 		/* Priority of the task. */
 	TaskHandle_t *pxTaskHandle;		/* Task handle for the task. */
@@ -17,11 +126,21 @@ typedef struct xExtended_TCB
 	TickType_t xPeriod;				/* Task period. */
 	TickType_t xLastWakeTime; 		/* Last time stamp when the task was running. */
 	TickType_t xMaxExecTime;		/* Worst-case execution time of the task. */
-	TickType_t xExecTime;			/* Current execution time of the task. */
+	TickType_t xExecTime;			/* Current execution time of the task, in microseconds with schedUSE_PRECISE_EXECUTION_TIME. */
 	TickType_t xStartTime;          /* Current start time of the task. */
 
 	BaseType_t xWorkIsDone; 		/* pdFALSE if the job is not finished, pdTRUE if the job is finished. */
 
+	#if( schedUSE_STATIC_ALLOCATION == 1 )
+		StaticTask_t xTaskBuffer;		/* FreeRTOS TCB of the task. */
+		StackType_t *puxStackBuffer;	/* Stack of the task, part of xStackPool. NULL until first created. */
+		configSTACK_DEPTH_TYPE usStackBufferDepth;	/* Size of puxStackBuffer in words. */
+	#endif /* schedUSE_STATIC_ALLOCATION */
+
+	#if( schedUSE_STACK_PROFILING == 1 )
+		configSTACK_DEPTH_TYPE usStackHighWaterMark;	/* Fewest free stack words seen, also before the task was recreated. */
+	#endif /* schedUSE_STACK_PROFILING */
+
 	#if( schedUSE_TCB_ARRAY == 1 )
 		BaseType_t xPriorityIsSet; 	/* pdTRUE if the priority is assigned. */
 		BaseType_t xInUse; 			/* pdFALSE if this extended TCB is empty. */
@@ -29,8 +148,35 @@ typedef struct xExtended_TCB
 
 	#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
 		BaseType_t xExecutedOnce;	/* pdTRUE if the task has executed once. */
+		UBaseType_t uxMissPolicy;	/* One of schedMISS_POLICY_*. */
+		BaseType_t xDeadlineMissed;	/* pdTRUE while a job that missed its deadline keeps running. */
 	#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 
+	#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+		TickType_t xResponseTime;	/* Worst-case response time, portMAX_DELAY if the deadline can be missed. */
+	#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+
+	#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+		UBaseType_t uxThreshold;	/* Priority of a started job, at least uxPriority. */
+		BaseType_t xThresholdHeld;	/* pdTRUE if still at the threshold after the job, see prvThresholdJobBegin. */
+	#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
+	#if( schedUSE_RESOURCES == 1 )
+		TickType_t xCriticalSection[ schedMAX_NUMBER_OF_RESOURCES ];	/* Longest critical section per resource, 0 if not used. */
+		UBaseType_t uxResourcesHeld;	/* One bit per resource the task holds. */
+	#endif /* schedUSE_RESOURCES */
+
+	#if( schedBACKGROUND_STEALS_SLACK )
+		TickType_t xStaticSlack;	/* Time that can be stolen in a busy period of this task's level. */
+		volatile TickType_t xSlack;	/* Slack left in the current busy period, charged by the tick hook. */
+	#endif /* schedBACKGROUND_STEALS_SLACK */
+
+	#if( schedUSE_TASK_STATISTICS == 1 )
+		StatsCollector_t xStatsCollector;
+		TickType_t xJobReleaseTime;	/* Release time of the current job. */
+		TickType_t xExecTimeCarry;	/* Execution time of the current job charged before the last budget reset. */
+	#endif /* schedUSE_TASK_STATISTICS */
+
 	#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 || schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
 		TickType_t xAbsoluteUnblockTime; /* The task will be unblocked at this time if it is blocked by the scheduler task. */
 	#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME || schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
@@ -42,7 +188,21 @@ typedef struct xExtended_TCB
 
 	#if( schedUSE_POLLING_SERVER == 1 )
 		BaseType_t xIsPollingServer; /* pdTRUE if the task is a polling server. */
+		struct xServerControl *pxServerControl;	/* State of the server, NULL for periodic tasks. */
+		#if( schedUSE_SPORADIC_SERVER == 1 )
+			BaseType_t xChunkActive;		/* pdTRUE while the Sporadic Server consumes budget. */
+			TickType_t xChunkStartTime;		/* Time the current chunk started, i.e. the server became active. */
+			TickType_t xChunkStartExecTime;	/* xExecTime at the start of the current chunk. */
+		#endif /* schedUSE_SPORADIC_SERVER */
+		#if( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+			TickType_t xLastJobDeadline;	/* Deadline given to the previous aperiodic job. */
+		#endif /* schedUSE_TOTAL_BANDWIDTH_SERVER */
 	#endif /* schedUSE_POLLING_SERVER */
+
+	#if( schedUSE_MODES == 1 )
+		ModeParams_t xModeParams[ schedMAX_NUMBER_OF_MODES ];
+		volatile BaseType_t xJobInProgress;	/* pdTRUE while a job runs, for the Polling Server while an aperiodic job runs. */
+	#endif /* schedUSE_MODES */
 	
 	/* add if you need anything else */	
 	
@@ -58,37 +218,206 @@ typedef struct xExtended_TCB
 		TickType_t xReleaseTime;
 		TickType_t xMaxExecTime;	/* Worst-case execution time of the aperiodic job. */
 		TickType_t xExecTime;		/* Current execution time of the aperiodic job. */
+		UBaseType_t uxPriority;		/* Orders jobs released at the same time. Higher is served first. */
+		#if( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+			TickType_t xAbsoluteDeadline;	/* Deadline assigned by the Total Bandwidth Server. */
+		#endif /* schedUSE_TOTAL_BANDWIDTH_SERVER */
 	} ATC_t;
 #endif /* schedUSE_APERIODIC_JOBS */
 
+#if( schedUSE_TRACE_BUFFER == 1 )
+	/* Binary trace record, 6 bytes on the ATmega2560. */
+	typedef struct xTraceRecord
+	{
+		uint8_t ucEvent;	/* One of schedTRACE_EVENT_*. */
+		uint8_t ucTaskId;	/* Index of the task in xTCBArray. */
+		TickType_t xTick;	/* Tick count when the event occurred. */
+	} TraceRecord_t;
+#endif /* schedUSE_TRACE_BUFFER */
+
+#if( schedUSE_STACK_PROFILING == 1 )
+	/* Stack profile of a task without extended TCB. */
+	typedef struct xStackProfile
+	{
+		const char *pcName;
+		TaskHandle_t *pxTaskHandle;
+		configSTACK_DEPTH_TYPE usStackDepth;
+		configSTACK_DEPTH_TYPE usHighWaterMark;
+	} StackProfile_t;
+#endif /* schedUSE_STACK_PROFILING */
+
+#if( schedUSE_POLLING_SERVER == 1 && schedUSE_SPORADIC_SERVER == 1 )
+	/* Pending budget replenishment of the Sporadic Server. */
+	typedef struct xSporadicReplenishment
+	{
+		TickType_t xTime;	/* Tick count at which the budget is given back. */
+		TickType_t xAmount;	/* Budget in ticks given back at xTime. */
+	} SSReplenishment_t;
+#endif /* schedUSE_SPORADIC_SERVER */
+
+#if( schedUSE_POLLING_SERVER == 1 )
+	/* State of a server besides its extended TCB. Every server has its own
+	 * queue of aperiodic jobs. */
+	typedef struct xServerControl
+	{
+		TaskHandle_t xHandle;	/* Handle of the server task. */
+		SchedTCB_t *pxTCB;
+		#if( schedUSE_APERIODIC_JOBS == 1 )
+			/* Extended ATCs (Aperiodic Task Control ), kept as a binary
+			 * min-heap ordered by prvATCIsBefore. */
+			ATC_t xATCArray[ schedMAX_NUMBER_OF_APERIODIC_JOBS ];
+			UBaseType_t uxAperiodicTaskCounter;
+			/* Job taken off the heap that is currently served. */
+			ATC_t xCurrentAperiodicJob;
+			ATC_t *pxCurrentAperiodicTask;
+			/* Lock-free ring for jobs submitted from interrupt handlers. The
+			 * head is only written by the producer (ISR), the tail only by the
+			 * consumer (server). Indices run freely and are masked on access. */
+			ATC_t xATCISRQueue[ schedAPERIODIC_ISR_QUEUE_LENGTH ];
+			volatile uint8_t ucATCISRQueueHead;
+			volatile uint8_t ucATCISRQueueTail;
+		#endif /* schedUSE_APERIODIC_JOBS */
+		#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+			/* Runs pxCurrentAperiodicTask on behalf of the server. Its thread
+			 * local storage points to the server's TCB, so it consumes server
+			 * budget. */
+			TaskHandle_t xAperiodicWorkerHandle;
+			/* pdTRUE once the worker has finished or aborted the current job. */
+			volatile BaseType_t xAperiodicJobDone;
+			/* Set by the tick hook when the current job exceeds its WCET. */
+			volatile BaseType_t xAperiodicJobOverrun;
+			#if( schedUSE_STATIC_ALLOCATION == 1 )
+				StaticTask_t xWorkerTaskBuffer;
+				StackType_t xWorkerStack[ schedAPERIODIC_WORKER_STACK_SIZE ];
+			#endif /* schedUSE_STATIC_ALLOCATION */
+			#if( schedUSE_STACK_PROFILING == 1 )
+				StackProfile_t xWorkerStackProfile;
+			#endif /* schedUSE_STACK_PROFILING */
+		#endif /* schedUSE_APERIODIC_WORKER_TASK */
+		#if( schedUSE_SPORADIC_SERVER == 1 )
+			/* Ring of pending replenishments, ordered by time. */
+			SSReplenishment_t xReplenishmentArray[ schedSPORADIC_SERVER_MAX_REPLENISHMENTS ];
+			UBaseType_t uxReplenishmentFirst;
+			UBaseType_t uxReplenishmentCounter;
+		#endif /* schedUSE_SPORADIC_SERVER */
+	} ServerControl_t;
+#endif /* schedUSE_POLLING_SERVER */
+
+static SchedTCB_t *prvGetTCBFromHandle( TaskHandle_t xTaskHandle );
+#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+	static TaskHandle_t prvGetExecutionHandle( SchedTCB_t *pxTCB );
+#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+#if( schedUSE_TASK_STATISTICS == 1 || ( schedUSE_PRECISE_EXECUTION_TIME == 1 && schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 ) )
+	static TickType_t prvGetExecTime( SchedTCB_t *pxTCB );
+#endif /* schedUSE_TASK_STATISTICS || schedUSE_PRECISE_EXECUTION_TIME */
+static void prvResetExecTime( SchedTCB_t *pxTCB );
+#if( schedUSE_TASK_STATISTICS == 1 )
+	static void prvStatsInit( StatsCollector_t *pxCollector );
+	static void prvStatsRecordJob( StatsCollector_t *pxCollector, TickType_t xExecTime, TickType_t xResponseTime, TickType_t xReleaseJitter );
+	static void prvStatsCopy( const StatsCollector_t *pxCollector, SchedTaskStats_t *pxStats );
+#endif /* schedUSE_TASK_STATISTICS */
+
 #if( schedUSE_TCB_ARRAY == 1 )
-	static BaseType_t prvGetTCBIndexFromHandle( TaskHandle_t xTaskHandle );
 	static void prvInitTCBArray( void );
 	/* Find index for an empty entry in xTCBArray. Return -1 if there is no empty entry. */
-	static BaseType_t prvFindEmptyElementIndexTCB( void );
-	/* Remove a pointer to extended TCB from xTCBArray. */
-	static void prvDeleteTCBFromArray( BaseType_t xIndex );
+	static BaseType_t prvFindEmptyElementIndexTCB( configSTACK_DEPTH_TYPE usStackDepth );
+	/* Insert an extended TCB into pxActiveTCBs. Returns its position. */
+	static BaseType_t prvAddTCBToArray( SchedTCB_t *pxTCB );
+	/* Remove an extended TCB from pxActiveTCBs and free it. Returns its former position. */
+	static BaseType_t prvDeleteTCBFromArray( SchedTCB_t *pxTCB );
 #endif /* schedUSE_TCB_ARRAY */
 
 static TickType_t xSystemStartTime = 0;
+/* pdTRUE once vSchedulerStart has created the tasks. */
+static BaseType_t xSchedulerStarted = pdFALSE;
+#if( schedUSE_TASK_TABLE == 1 )
+	/* pdTRUE while the task set is the one of a task table, whose priorities
+	 * and response times were computed at compile time. */
+	static BaseType_t xTaskTableInUse = pdFALSE;
+#endif /* schedUSE_TASK_TABLE */
 
 static void prvPeriodicTaskCode( void *pvParameters );
+#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+	static void prvThresholdJobBegin( SchedTCB_t *pxThisTask );
+#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+static SchedTCB_t *prvPeriodicTaskInit( TaskFunction_t pvTaskCode, const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, void *pvParameters,
+		UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick,
+		TickType_t xDeadlineTick, UBaseType_t uxMissPolicy );
+static BaseType_t prvPeriodicTaskActivate( SchedTCB_t *pxTCB );
+static void prvTaskSetChanged( BaseType_t xPosition );
+#if( schedUSE_MODES == 1 )
+	static void prvModeParamsInit( SchedTCB_t *pxTCB );
+	static BaseType_t prvIsInMode( const SchedTCB_t *pxTCB, UBaseType_t uxMode );
+	static void prvModeEnter( UBaseType_t uxMode );
+	static void prvModeJobBegin( SchedTCB_t *pxTCB );
+	static void prvModeJobEnd( SchedTCB_t *pxTCB );
+	static void prvModeChangeApply( void );
+#endif /* schedUSE_MODES */
+static BaseType_t prvCreateTask( SchedTCB_t *pxTCB );
 static void prvCreateAllTasks( void );
+#if( schedUSE_MODES == 1 || schedUSE_RESOURCES == 1 )
+	static SchedTCB_t *prvFindTCBByHandlePointer( TaskHandle_t *pxTaskHandle );
+#endif /* schedUSE_MODES || schedUSE_RESOURCES */
+#if( schedUSE_RESOURCES == 1 )
+	static UBaseType_t prvResourcePriority( const SchedTCB_t *pxTCB );
+	static void prvResourceUpdateCeilings( void );
+	static void prvResourceReleaseAll( SchedTCB_t *pxTCB );
+	static void prvResourceJobBegin( const SchedTCB_t *pxThisTask );
+#endif /* schedUSE_RESOURCES */
+
+static void prvTraceEvent( uint8_t ucEvent, SchedTCB_t *pxTCB, TickType_t xTick );
+static void prvTracePrint( uint8_t ucEvent, SchedTCB_t *pxTCB, TickType_t xTick );
+#if( schedUSE_TRACE_BUFFER == 1 )
+	static void prvTraceDrainFunction( void *pvParameters );
+	static void prvCreateTraceDrainTask( void );
+#endif /* schedUSE_TRACE_BUFFER */
+#if( schedUSE_STACK_PROFILING == 1 )
+	static void prvStackSample( TaskHandle_t xTaskHandle, configSTACK_DEPTH_TYPE *pusHighWaterMark );
+	static void prvStackFillUsage( const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, configSTACK_DEPTH_TYPE usHighWaterMark, SchedStackUsage_t *pxUsage );
+#endif /* schedUSE_STACK_PROFILING */
 
 
 #if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
-	static void prvSetFixedPriorities( void );	
-#endif /* schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY_DMS */
+	static void prvSetFixedPriorities( BaseType_t xFrom );
+	#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+		static TickType_t prvReleaseJitter( const SchedTCB_t *pxTCB );
+		static TickType_t prvReleasesBefore( const SchedTCB_t *pxTCB, TickType_t xTime );
+		static TickType_t prvReleasesUpTo( const SchedTCB_t *pxTCB, TickType_t xTime );
+		static UBaseType_t prvPreemptionThreshold( const SchedTCB_t *pxTCB );
+		static TickType_t prvBlocking( const SchedTCB_t *pxTCB );
+		static TickType_t prvInterference( const SchedTCB_t *pxTCB, TickType_t xWindow );
+		static TickType_t prvFinishTime( const SchedTCB_t *pxTCB, TickType_t xBlocking, TickType_t xJob );
+		static TickType_t prvResponseTime( const SchedTCB_t *pxTCB, TickType_t xBlocking );
+		static BaseType_t prvResponseTimes( void );
+		static BaseType_t prvResponseTimeAnalysis( void );
+		#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			static BaseType_t prvPriorityLevelTaken( const SchedTCB_t *pxTCB, UBaseType_t uxLevel );
+			static void prvAssignPreemptionThresholds( void );
+		#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+		#if( schedBACKGROUND_STEALS_SLACK )
+			static TickType_t prvStaticSlack( const SchedTCB_t *pxTCB );
+		#endif /* schedBACKGROUND_STEALS_SLACK */
+	#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+#elif( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+	static void prvUpdatePrioritiesEDF( void );
+#endif /* schedSCHEDULING_POLICY */
 
 #if( schedUSE_SCHEDULER_TASK == 1 )
 	static void prvSchedulerCheckTimingError( TickType_t xTickCount, SchedTCB_t *pxTCB );
 	static void prvSchedulerFunction( void );
 	static void prvCreateSchedulerTask( void );
 	static void prvWakeScheduler( void );
+	static void prvSchedulerRequestWake( TickType_t xWakeTime );
+
+	#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+		static TickType_t prvTimeUntil( TickType_t xTime, TickType_t xTickCount );
+		static TickType_t prvGetTimingEventDelay( SchedTCB_t *pxTCB, TickType_t xTickCount );
+	#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
 	#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
 		static void prvPeriodicTaskRecreate( SchedTCB_t *pxTCB );
 		static void prvDeadlineMissedHook( SchedTCB_t *pxTCB, TickType_t xTickCount );
+		static void prvLateJobCompleted( SchedTCB_t *pxTCB, TickType_t xTickCount );
 		static void prvCheckDeadline( SchedTCB_t *pxTCB, TickType_t xTickCount );				
 	#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 
@@ -100,12 +429,46 @@ static void prvCreateAllTasks( void );
 
 #if( schedUSE_POLLING_SERVER == 1 )
 	static void prvPollingServerFunction( void );
-	void prvCreatePollingServer( void );
+	static BaseType_t prvCreateServer( const char *pcName, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick );
+	#if( schedUSE_DEFERRABLE_SERVER == 1 )
+		static BaseType_t prvDeferrableServerWait( SchedTCB_t *pxServer );
+	#endif /* schedUSE_DEFERRABLE_SERVER */
+	#if( schedUSE_SPORADIC_SERVER == 1 )
+		static void prvSporadicServerChunkStart( SchedTCB_t *pxServer, TickType_t xTickCount );
+		static void prvSporadicServerChunkEnd( SchedTCB_t *pxServer, TickType_t xTickCount );
+		static void prvSporadicServerReplenish( SchedTCB_t *pxServer, TickType_t xTickCount );
+	#endif /* schedUSE_SPORADIC_SERVER */
+	#if( schedUSE_SPORADIC_SERVER == 1 || schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+		static void prvServerWaitForJob( SchedTCB_t *pxServer );
+	#endif /* schedUSE_SPORADIC_SERVER || schedUSE_TOTAL_BANDWIDTH_SERVER */
+	static void prvRunAperiodicJob( SchedTCB_t *pxServer, ATC_t *pxJob );
+	#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+		static void prvAperiodicWorkerFunction( void *pvParameters );
+		static void prvCreateAperiodicWorker( ServerControl_t *pxControl );
+		static void prvAbortAperiodicJob( ServerControl_t *pxControl );
+	#endif /* schedUSE_APERIODIC_WORKER_TASK */
+	#if( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+		static TickType_t prvTotalBandwidthServerBudgetTime( TickType_t xExecTime );
+		static void prvTotalBandwidthServerDispatch( SchedTCB_t *pxServer, ATC_t *pxJob );
+	#endif /* schedUSE_TOTAL_BANDWIDTH_SERVER */
+	#if( schedUSE_BACKGROUND_SERVICE == 1 )
+		static ATC_t *prvBackgroundServiceTakeJob( TickType_t *pxTimeout );
+		static void prvBackgroundServiceFunction( void *pvParameters );
+		static void prvCreateBackgroundServiceTask( void );
+		#if( schedUSE_SLACK_STEALING == 1 )
+			static BaseType_t prvSlackAvailable( void );
+			static void prvSlackStealingTick( TaskHandle_t xCurrentTask );
+		#endif /* schedUSE_SLACK_STEALING */
+	#endif /* schedUSE_BACKGROUND_SERVICE */
 #endif /* schedUSE_POLLING_SERVER */
 
 #if( schedUSE_APERIODIC_JOBS == 1 )
-	static ATC_t *prvGetNextAperiodicTask( void );
-	static BaseType_t prvGetEmptyIndexATC( void );
+	static ATC_t *prvGetNextAperiodicTask( ServerControl_t *pxControl );
+	static BaseType_t prvATCIsBefore( const ATC_t *pxA, const ATC_t *pxB );
+	static void prvATCSwap( ServerControl_t *pxControl, UBaseType_t uxA, UBaseType_t uxB );
+	static void prvATCHeapPop( ServerControl_t *pxControl, ATC_t *pxJob );
+	static BaseType_t prvATCHeapPush( ServerControl_t *pxControl, const ATC_t *pxJob );
+	static void prvATCDrainISRQueue( ServerControl_t *pxControl );
 #endif /* schedUSE_APERIODIC_JOBS */
 
 #if( schedUSE_TCB_ARRAY == 1 )
@@ -113,53 +476,399 @@ static void prvCreateAllTasks( void );
 	static SchedTCB_t xTCBArray[ schedMAX_NUMBER_OF_PERIODIC_TASKS ] = { 0 };
 	/* Counter for number of periodic tasks. */
 	static BaseType_t xTaskCounter = 0;
+	/* The first xTaskCounter entries point to the extended TCBs in use,
+	 * ordered by priority under RMS and DMS. Entries of xTCBArray never move
+	 * because thread local storage points to them. Both change in critical
+	 * sections only, slack stealing walks the index from the tick hook. */
+	static SchedTCB_t *pxActiveTCBs[ schedMAX_NUMBER_OF_PERIODIC_TASKS ];
 #endif /* schedUSE_TCB_ARRAY */
 
+#if( schedUSE_RESOURCES == 1 )
+	/* A resource shared by periodic tasks. */
+	typedef struct xResourceControl
+	{
+		const char *pcName;
+		UBaseType_t uxCeiling;	/* Highest priority of the users. */
+		SchedTCB_t *pxHolder;	/* NULL while the resource is free. */
+	} ResourceControl_t;
+
+	static ResourceControl_t xResourceArray[ schedMAX_NUMBER_OF_RESOURCES ];
+	static UBaseType_t uxResourceCounter = 0;
+#endif /* schedUSE_RESOURCES */
+
+#if( schedUSE_MODES == 1 )
+	/* Names of the modes, NULL if not created. */
+	static const char *pcModeNames[ schedMAX_NUMBER_OF_MODES ] = { "Default" };
+	static UBaseType_t uxCurrentMode = 0;
+	/* Mode to change to while xModeChangePending is pdTRUE. */
+	static UBaseType_t uxRequestedMode = 0;
+	static volatile BaseType_t xModeChangePending = pdFALSE;
+#endif /* schedUSE_MODES */
+
+#if( schedUSE_STATIC_ALLOCATION == 1 )
+	/* Stacks of periodic tasks. Handed out in order and never returned, a
+	 * stack stays with its extended TCB and serves every later task of that
+	 * TCB that fits in it. */
+	static StackType_t xStackPool[ schedSTATIC_STACK_POOL_SIZE ];
+	static size_t xStackPoolUsed = 0;
+#endif /* schedUSE_STATIC_ALLOCATION */
+
+#if( schedUSE_TRACE_BUFFER == 1 )
+	/* Ring of trace records. Written from tasks and the tick hook under a
+	 * short critical section, read by the drain task only. */
+	static TraceRecord_t xTraceBuffer[ schedTRACE_BUFFER_LENGTH ];
+	static uint8_t ucTraceHead = 0;
+	static uint8_t ucTraceTail = 0;
+	/* Number of records dropped because the buffer was full. */
+	static UBaseType_t uxTraceOverflowCount = 0;
+	static TaskHandle_t xTraceDrainHandle = NULL;
+#endif /* schedUSE_TRACE_BUFFER */
+
+#if( schedUSE_TASK_STATISTICS == 1 && schedUSE_APERIODIC_JOBS == 1 )
+	/* Statistics of all aperiodic jobs together. */
+	static StatsCollector_t xAperiodicStats;
+#endif /* schedUSE_TASK_STATISTICS */
+
+#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+	/* Extended TCB of the running task, NULL if it has none. */
+	static SchedTCB_t *pxSwitchedInTCB = NULL;
+	/* schedCLOCK_US when the running task was switched in. */
+	static uint32_t ulSwitchedInTime = 0;
+#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+
 #if( schedUSE_SCHEDULER_TASK )
-	static TickType_t xSchedulerWakeCounter = 0; /* useful. why? */
+	/* Tick count at which the tick hook wakes the scheduler task next, valid
+	 * while xSchedulerWakeArmed is pdTRUE. */
+	static TickType_t xSchedulerNextWakeTime = 0;
+	static BaseType_t xSchedulerWakeArmed = pdFALSE;
 	static TaskHandle_t xSchedulerHandle = NULL; /* useful. why? */
 #endif /* schedUSE_SCHEDULER_TASK */
 
 #if( schedUSE_APERIODIC_JOBS == 1 )
-	/* Array for extended ATCs (Aperiodic Task Control ). */
-	static ATC_t xATCArray[ schedMAX_NUMBER_OF_APERIODIC_JOBS ] = { 0 };
-	//static ATC_t xATCBridgeArray[ schedMAX_NUMBER_OF_APERIODIC_JOBS ] = { 0 };
-	static BaseType_t xATCArrayFirst = 0;
-	static BaseType_t xATCArrayLast = 0;
-	static UBaseType_t uxAperiodicTaskCounter = 0;
+	/* Keeps the compiler from moving ring accesses across index updates. */
+	#define schedCOMPILER_BARRIER() __asm__ __volatile__( "" ::: "memory" )
 #endif /* schedUSE_APERIODIC_JOBS */
 
 #if( schedUSE_POLLING_SERVER == 1 )
-    static TaskHandle_t xPollingServerHandle = NULL;
-	#if( schedUSE_APERIODIC_JOBS == 1 )
-		static ATC_t *pxCurrentAperiodicTask;
-	#endif /* schedUSE_APERIODIC_JOBS */
+	/* Servers in order of creation. Server 0 is created by vSchedulerInit. */
+	static ServerControl_t xServerArray[ schedMAX_NUMBER_OF_SERVERS ];
+	static UBaseType_t uxServerCounter = 0;
+	#if( schedUSE_BACKGROUND_SERVICE == 1 )
+		static TaskHandle_t xBackgroundHandle = NULL;
+		/* Job run by the background service. Its xExecTime is charged by the
+		 * tick hook. */
+		static ATC_t xBackgroundJob;
+		#if( schedUSE_SLACK_STEALING == 1 )
+			/* pdTRUE while the background service runs a job on slack. */
+			static volatile BaseType_t xSlackStealing = pdFALSE;
+			/* Set by the tick hook when the slack has run out during a job,
+			 * so the scheduler task lowers the background service. */
+			static volatile BaseType_t xSlackExhausted = pdFALSE;
+		#endif /* schedUSE_SLACK_STEALING */
+	#endif /* schedUSE_BACKGROUND_SERVICE */
 #endif /* schedUSE_POLLING_SERVER */
 
-#if( schedUSE_TCB_ARRAY == 1 )
-	/* Returns index position in xTCBArray of TCB with same task handle as parameter. */
-	static BaseType_t prvGetTCBIndexFromHandle( TaskHandle_t xTaskHandle )
+#if( schedUSE_STACK_PROFILING == 1 )
+	/* Aperiodic workers are profiled in their ServerControl_t. */
+	#if( schedUSE_POLLING_SERVER == 1 && schedUSE_BACKGROUND_SERVICE == 1 )
+		#define schedNUMBER_OF_SYSTEM_TASKS ( schedUSE_SCHEDULER_TASK + schedUSE_TRACE_BUFFER + 1 )
+	#else
+		#define schedNUMBER_OF_SYSTEM_TASKS ( schedUSE_SCHEDULER_TASK + schedUSE_TRACE_BUFFER )
+	#endif /* schedUSE_BACKGROUND_SERVICE */
+	#if( schedNUMBER_OF_SYSTEM_TASKS > 0 )
+		/* Stack profiles of the tasks of this library without extended TCB. */
+		static StackProfile_t xSystemStackProfiles[ schedNUMBER_OF_SYSTEM_TASKS ] =
+		{
+			#if( schedUSE_SCHEDULER_TASK == 1 )
+				{ "Scheduler", &xSchedulerHandle, schedSCHEDULER_TASK_STACK_SIZE, schedSCHEDULER_TASK_STACK_SIZE },
+			#endif /* schedUSE_SCHEDULER_TASK */
+			#if( schedUSE_TRACE_BUFFER == 1 )
+				{ "Trace", &xTraceDrainHandle, schedTRACE_DRAIN_TASK_STACK_SIZE, schedTRACE_DRAIN_TASK_STACK_SIZE },
+			#endif /* schedUSE_TRACE_BUFFER */
+			#if( schedUSE_POLLING_SERVER == 1 && schedUSE_BACKGROUND_SERVICE == 1 )
+				{ "BG", &xBackgroundHandle, schedBACKGROUND_SERVICE_STACK_SIZE, schedBACKGROUND_SERVICE_STACK_SIZE },
+			#endif /* schedUSE_BACKGROUND_SERVICE */
+		};
+	#endif /* schedNUMBER_OF_SYSTEM_TASKS */
+#endif /* schedUSE_STACK_PROFILING */
+
+/* Returns the extended TCB attached to the given task handle, or NULL if the
+ * task is not managed by this library (e.g. idle task, scheduler task). The
+ * pointer lives in the task's thread local storage, so the lookup is O(1) and
+ * may be used from the tick hook. Pass NULL to look up the calling task. */
+static SchedTCB_t *prvGetTCBFromHandle( TaskHandle_t xTaskHandle )
+{
+	return ( SchedTCB_t * ) pvTaskGetThreadLocalStoragePointer( xTaskHandle, schedTHREAD_LOCAL_STORAGE_POINTER_INDEX );
+}
+
+#if( schedUSE_MODES == 1 || schedUSE_RESOURCES == 1 )
+	/* Returns the extended TCB of the periodic task with the given handle
+	 * pointer, or NULL if there is none. Tasks are known by the pointer
+	 * before they have a handle. */
+	static SchedTCB_t *prvFindTCBByHandlePointer( TaskHandle_t *pxTaskHandle )
 	{
-		static BaseType_t xIndex = 0;
-		BaseType_t xIterator;
+		BaseType_t xIndex;
 
-		for( xIterator = 0; xIterator < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIterator++ )
+		for( xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++ )
 		{
-		
-			if( pdTRUE == xTCBArray[ xIndex ].xInUse && *xTCBArray[ xIndex ].pxTaskHandle == xTaskHandle )
+			if( pdTRUE == xTCBArray[ xIndex ].xInUse && pxTaskHandle == xTCBArray[ xIndex ].pxTaskHandle )
 			{
-				return xIndex;
+				return &xTCBArray[ xIndex ];
 			}
-		
-			xIndex++;
-			if( schedMAX_NUMBER_OF_PERIODIC_TASKS == xIndex )
+		}
+		return NULL;
+	}
+#endif /* schedUSE_MODES || schedUSE_RESOURCES */
+
+#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+	/* Returns the task that consumes the budget of the given TCB and is
+	 * suspended when it is exhausted. This is the aperiodic worker for the
+	 * server, if enabled, and the task itself otherwise. */
+	static TaskHandle_t prvGetExecutionHandle( SchedTCB_t *pxTCB )
+	{
+		#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+			if( pdTRUE == pxTCB->xIsPollingServer )
+			{
+				return pxTCB->pxServerControl->xAperiodicWorkerHandle;
+			}
+		#endif /* schedUSE_APERIODIC_WORKER_TASK */
+		return *pxTCB->pxTaskHandle;
+	}
+#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+
+#if( schedUSE_TASK_STATISTICS == 1 || ( schedUSE_PRECISE_EXECUTION_TIME == 1 && schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 ) )
+	/* Returns the execution time charged to the given task since its budget
+	 * was last reset, including the running slice. */
+	static TickType_t prvGetExecTime( SchedTCB_t *pxTCB )
+	{
+		#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+			if( pxTCB == pxSwitchedInTCB )
+			{
+				return pxTCB->xExecTime + ( schedCLOCK_US() - ulSwitchedInTime );
+			}
+		#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+		return pxTCB->xExecTime;
+	}
+#endif /* schedUSE_TASK_STATISTICS || schedUSE_PRECISE_EXECUTION_TIME */
+
+/* Starts a new budget for the given task. Time the running task has used
+ * before is not carried over. */
+static void prvResetExecTime( SchedTCB_t *pxTCB )
+{
+	#if( schedUSE_TASK_STATISTICS == 1 )
+		pxTCB->xExecTimeCarry += prvGetExecTime( pxTCB );
+	#endif /* schedUSE_TASK_STATISTICS */
+	#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+		if( pxTCB == pxSwitchedInTCB )
+		{
+			ulSwitchedInTime = schedCLOCK_US();
+		}
+	#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+	pxTCB->xExecTime = 0;
+}
+
+#if( schedUSE_TASK_STATISTICS == 1 )
+	static void prvStatsInit( StatsCollector_t *pxCollector )
+	{
+		*pxCollector = StatsCollector_t();
+		pxCollector->xStats.xMinExecTime = portMAX_DELAY;
+		pxCollector->xStats.xMinResponseTime = portMAX_DELAY;
+	}
+
+	/* Adds a completed job. Called with the job's task or server running. */
+	static void prvStatsRecordJob( StatsCollector_t *pxCollector, TickType_t xExecTime, TickType_t xResponseTime, TickType_t xReleaseJitter )
+	{
+		SchedTaskStats_t *pxStats = &pxCollector->xStats;
+		TickType_t xBucket = xResponseTime / schedSTATS_HISTOGRAM_BUCKET_WIDTH;
+
+		taskENTER_CRITICAL();
+		pxStats->ulJobCount++;
+		if( xExecTime < pxStats->xMinExecTime )
+		{
+			pxStats->xMinExecTime = xExecTime;
+		}
+		if( xExecTime > pxStats->xMaxExecTime )
+		{
+			pxStats->xMaxExecTime = xExecTime;
+		}
+		if( xResponseTime < pxStats->xMinResponseTime )
+		{
+			pxStats->xMinResponseTime = xResponseTime;
+		}
+		if( xResponseTime > pxStats->xMaxResponseTime )
+		{
+			pxStats->xMaxResponseTime = xResponseTime;
+		}
+		if( xReleaseJitter > pxStats->xMaxReleaseJitter )
+		{
+			pxStats->xMaxReleaseJitter = xReleaseJitter;
+		}
+		pxStats->ulResponseTimeHistogram[ ( xBucket < schedSTATS_HISTOGRAM_BUCKETS ) ? xBucket : schedSTATS_HISTOGRAM_BUCKETS - 1 ]++;
+		pxCollector->ullExecTimeSum += xExecTime;
+		pxCollector->ullResponseTimeSum += xResponseTime;
+		taskEXIT_CRITICAL();
+	}
+
+	static void prvStatsCopy( const StatsCollector_t *pxCollector, SchedTaskStats_t *pxStats )
+	{
+		taskENTER_CRITICAL();
+		*pxStats = pxCollector->xStats;
+		uint64_t ullExecTimeSum = pxCollector->ullExecTimeSum;
+		uint64_t ullResponseTimeSum = pxCollector->ullResponseTimeSum;
+		taskEXIT_CRITICAL();
+
+		if( pxStats->ulJobCount > 0 )
+		{
+			pxStats->xMeanExecTime = ( TickType_t ) ( ullExecTimeSum / pxStats->ulJobCount );
+			pxStats->xMeanResponseTime = ( TickType_t ) ( ullResponseTimeSum / pxStats->ulJobCount );
+		}
+	}
+
+	/* Copies the statistics of a periodic task. */
+	BaseType_t xSchedulerGetTaskStats( TaskHandle_t xTaskHandle, SchedTaskStats_t *pxStats )
+	{
+		SchedTCB_t *pxTCB = prvGetTCBFromHandle( xTaskHandle );
+
+		if( NULL == pxTCB || NULL == xTaskHandle )
+		{
+			return pdFAIL;
+		}
+		prvStatsCopy( &pxTCB->xStatsCollector, pxStats );
+		return pdPASS;
+	}
+#endif /* schedUSE_TASK_STATISTICS */
+
+#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+	/* Called by the kernel after it has selected the task to run. */
+	void vSchedulerTaskSwitchedIn( void )
+	{
+		pxSwitchedInTCB = prvGetTCBFromHandle( xTaskGetCurrentTaskHandle() );
+		ulSwitchedInTime = schedCLOCK_US();
+	}
+
+	/* Called by the kernel before it selects another task. Charges the time
+	 * since the last switch in to the running task. */
+	void vSchedulerTaskSwitchedOut( void )
+	{
+		if( pxSwitchedInTCB != NULL )
+		{
+			pxSwitchedInTCB->xExecTime += schedCLOCK_US() - ulSwitchedInTime;
+		}
+	}
+#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+
+/* Reports a scheduler event of the given task. Costs a few instructions when
+ * the trace buffer is enabled, otherwise prints the event right away. May be
+ * called from the tick hook. */
+static void prvTraceEvent( uint8_t ucEvent, SchedTCB_t *pxTCB, TickType_t xTick )
+{
+	schedTRACE_EVENT_HOOK( ucEvent, pxTCB->pcName, xTick );
+
+	#if( schedUSE_TRACE_BUFFER == 1 )
+		taskENTER_CRITICAL();
+		if( ( uint8_t ) ( ucTraceHead - ucTraceTail ) >= schedTRACE_BUFFER_LENGTH )
+		{
+			uxTraceOverflowCount++;
+		}
+		else
+		{
+			TraceRecord_t *pxRecord = &xTraceBuffer[ ucTraceHead & ( schedTRACE_BUFFER_LENGTH - 1 ) ];
+			pxRecord->ucEvent = ucEvent;
+			pxRecord->ucTaskId = ( uint8_t ) ( pxTCB - xTCBArray );
+			pxRecord->xTick = xTick;
+			ucTraceHead++;
+		}
+		taskEXIT_CRITICAL();
+	#else
+		prvTracePrint( ucEvent, pxTCB, xTick );
+	#endif /* schedUSE_TRACE_BUFFER */
+}
+
+/* Prints a scheduler event over Serial. */
+static void prvTracePrint( uint8_t ucEvent, SchedTCB_t *pxTCB, TickType_t xTick )
+{
+	switch( ucEvent )
+	{
+		case schedTRACE_EVENT_START:
+			Serial.print(pxTCB->pcName);
+			Serial.print(" - START - ");
+			break;
+		case schedTRACE_EVENT_END:
+			Serial.print(pxTCB->pcName);
+			Serial.print(" - END - ");
+			break;
+		case schedTRACE_EVENT_MISS:
+			Serial.print("Deadline missed - ");
+			Serial.print(pxTCB->pcName);
+			Serial.print(" - ");
+			break;
+		case schedTRACE_EVENT_OVERRUN:
+			Serial.print(pxTCB->pcName);
+			Serial.print(" Exceeded - ");
+			break;
+		case schedTRACE_EVENT_SUSPEND:
+			Serial.print(pxTCB->pcName);
+			Serial.print(" suspended - ");
+			break;
+		case schedTRACE_EVENT_RESUME:
+			Serial.print(pxTCB->pcName);
+			Serial.print(" resumed - ");
+			break;
+		case schedTRACE_EVENT_ABORT:
+			Serial.print(pxTCB->pcName);
+			Serial.print(" aborted job - ");
+			break;
+		default:
+			break;
+	}
+	Serial.print(xTick);
+	Serial.print("\n");
+	#if( schedUSE_TRACE_BUFFER == 0 )
+		Serial.flush();
+	#endif /* schedUSE_TRACE_BUFFER */
+}
+
+#if( schedUSE_TRACE_BUFFER == 1 )
+	/* Function code for the trace drain task. Prints all buffered records once
+	 * per schedTRACE_DRAIN_PERIOD, at the lowest priority. */
+	static void prvTraceDrainFunction( void *pvParameters )
+	{
+		TraceRecord_t xRecord;
+
+		for( ; ; )
+		{
+			while( ucTraceTail != ucTraceHead )
 			{
-				xIndex = 0;
+				taskENTER_CRITICAL();
+				xRecord = xTraceBuffer[ ucTraceTail & ( schedTRACE_BUFFER_LENGTH - 1 ) ];
+				ucTraceTail++;
+				taskEXIT_CRITICAL();
+				prvTracePrint( xRecord.ucEvent, &xTCBArray[ xRecord.ucTaskId ], xRecord.xTick );
 			}
+			vTaskDelay( schedTRACE_DRAIN_PERIOD );
 		}
-		return -1;
 	}
 
+	/* Creates the trace drain task. */
+	static void prvCreateTraceDrainTask( void )
+	{
+		#if( schedUSE_STATIC_ALLOCATION == 1 )
+			static StaticTask_t xDrainTaskBuffer;
+			static StackType_t xDrainStack[ schedTRACE_DRAIN_TASK_STACK_SIZE ];
+			xTraceDrainHandle = xTaskCreateStatic( prvTraceDrainFunction, "Trace", schedTRACE_DRAIN_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY, xDrainStack, &xDrainTaskBuffer );
+		#else
+			xTaskCreate( prvTraceDrainFunction, "Trace", schedTRACE_DRAIN_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY, &xTraceDrainHandle );
+		#endif /* schedUSE_STATIC_ALLOCATION */
+	}
+
+	/* Returns the number of trace records dropped because the buffer was full. */
+	UBaseType_t uxSchedulerGetTraceOverflowCount( void )
+	{
+		return uxTraceOverflowCount;
+	}
+#endif /* schedUSE_TRACE_BUFFER */
+
+#if( schedUSE_TCB_ARRAY == 1 )
 	/* Initializes xTCBArray. */
 	static void prvInitTCBArray( void )
 	{
@@ -168,104 +877,245 @@ static void prvCreateAllTasks( void );
 		{
 			xTCBArray[ uxIndex ].xInUse = pdFALSE;
 			xTCBArray[uxIndex].pxTaskHandle = NULL;
+			#if( schedUSE_STATIC_ALLOCATION == 1 )
+				xTCBArray[ uxIndex ].puxStackBuffer = NULL;
+				xTCBArray[ uxIndex ].usStackBufferDepth = 0;
+			#endif /* schedUSE_STATIC_ALLOCATION */
 		}
 	}
 
-	/* Find index for an empty entry in xTCBArray. Returns -1 if there is no empty entry. */
-	static BaseType_t prvFindEmptyElementIndexTCB( void )
+	/* Find index for an empty entry in xTCBArray. Returns -1 if there is no empty entry.
+	 * With static allocation an entry keeps the stack of its last task, so
+	 * the entry with the smallest stack of at least usStackDepth words is
+	 * taken, else one without a stack. Only if neither exists does the
+	 * stack of the entry go to waste. */
+	static BaseType_t prvFindEmptyElementIndexTCB( configSTACK_DEPTH_TYPE usStackDepth )
 	{
 		BaseType_t xIndex;
+		BaseType_t xFound = -1;
 		for(xIndex=0;xIndex<schedMAX_NUMBER_OF_PERIODIC_TASKS;xIndex++){
 			if(!xTCBArray[xIndex].xInUse){
-				break;
+				#if( schedUSE_STATIC_ALLOCATION == 1 )
+					const SchedTCB_t *pxFree = &xTCBArray[ xIndex ];
+					BaseType_t xFits = ( pxFree->usStackBufferDepth >= usStackDepth ) ? pdTRUE : pdFALSE;
+					BaseType_t xFoundFits = ( -1 != xFound && xTCBArray[ xFound ].usStackBufferDepth >= usStackDepth ) ? pdTRUE : pdFALSE;
+					if( -1 == xFound ||
+							( pdTRUE == xFits && ( pdFALSE == xFoundFits || pxFree->usStackBufferDepth < xTCBArray[ xFound ].usStackBufferDepth ) ) ||
+							( pdFALSE == xFoundFits && NULL == pxFree->puxStackBuffer ) )
+					{
+						xFound = xIndex;
+					}
+				#else
+					( void ) usStackDepth;
+					xFound = xIndex;
+					break;
+				#endif /* schedUSE_STATIC_ALLOCATION */
 			}
 		}
-		if(xIndex == schedMAX_NUMBER_OF_PERIODIC_TASKS){
-			xIndex = -1;
-		}
-		return xIndex;
+		return xFound;
+
+	}
+
+	/* Returns pdTRUE if pxA gets a higher priority than pxB. Tasks of equal
+	 * rank keep the order they were added in. */
+	static BaseType_t prvIsHigherRank( const SchedTCB_t *pxA, const SchedTCB_t *pxB )
+	{
+		#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS )
+			return ( pxA->xPeriod < pxB->xPeriod ) ? pdTRUE : pdFALSE;
+		#elif( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
+			return ( pxA->xRelativeDeadline < pxB->xRelativeDeadline ) ? pdTRUE : pdFALSE;
+		#else
+			/* EDF orders the tasks by itself. */
+			( void ) pxA;
+			( void ) pxB;
+			return pdFALSE;
+		#endif /* schedSCHEDULING_POLICY */
+	}
 
+	/* Insert an extended TCB into pxActiveTCBs. Returns its position. Once
+	 * the scheduler runs, callers suspend it so that the scheduler task never
+	 * sees a half updated index. Slack stealing walks the index from the tick
+	 * hook, so it is changed in a critical section. */
+	static BaseType_t prvAddTCBToArray( SchedTCB_t *pxTCB )
+	{
+		BaseType_t xPosition = xTaskCounter;
+
+		configASSERT( xTaskCounter < schedMAX_NUMBER_OF_PERIODIC_TASKS );
+		taskENTER_CRITICAL();
+		while( xPosition > 0 && pdTRUE == prvIsHigherRank( pxTCB, pxActiveTCBs[ xPosition - 1 ] ) )
+		{
+			pxActiveTCBs[ xPosition ] = pxActiveTCBs[ xPosition - 1 ];
+			xPosition--;
+		}
+		pxActiveTCBs[ xPosition ] = pxTCB;
+		xTaskCounter++;
+		taskEXIT_CRITICAL();
+		return xPosition;
 	}
 
-	/* Remove a pointer to extended TCB from xTCBArray. */
-	static void prvDeleteTCBFromArray( BaseType_t xIndex )
+	/* Remove an extended TCB from pxActiveTCBs and free it. Returns its
+	 * former position. The order of the other tasks is kept. Like
+	 * prvAddTCBToArray, the index changes in a critical section. */
+	static BaseType_t prvDeleteTCBFromArray( SchedTCB_t *pxTCB )
 	{
-		configASSERT(xIndex>=0);
-		if(xTCBArray[xIndex].xInUse == pdTRUE){
-			xTCBArray[xIndex].xInUse = pdFALSE;
-			xTaskCounter--;
+		BaseType_t xPosition = 0;
+
+		configASSERT( pdTRUE == pxTCB->xInUse );
+		while( xPosition < xTaskCounter && pxActiveTCBs[ xPosition ] != pxTCB )
+		{
+			xPosition++;
+		}
+		configASSERT( xPosition < xTaskCounter );
+		taskENTER_CRITICAL();
+		xTaskCounter--;
+		for( BaseType_t xIndex = xPosition; xIndex < xTaskCounter; xIndex++ )
+		{
+			pxActiveTCBs[ xIndex ] = pxActiveTCBs[ xIndex + 1 ];
 		}
+		taskEXIT_CRITICAL();
+		pxTCB->xInUse = pdFALSE;
+		return xPosition;
 	}
 	
 #endif /* schedUSE_TCB_ARRAY */
 
+#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+	/* Raises the running task to its threshold for a new job. Tasks that
+	 * completed a job since are blocked at their threshold and are lowered
+	 * first, which never switches. A task released before any job started
+	 * wins against the tasks its threshold covers, the blocking the analysis
+	 * allows for it. */
+	static void prvThresholdJobBegin( SchedTCB_t *pxThisTask )
+	{
+		vTaskSuspendAll();
+		for( BaseType_t xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+			if( pdTRUE == pxTCB->xThresholdHeld && pxTCB != pxThisTask && *pxTCB->pxTaskHandle != NULL )
+			{
+				vTaskPrioritySet( *pxTCB->pxTaskHandle, pxTCB->uxPriority );
+				pxTCB->xThresholdHeld = pdFALSE;
+			}
+		}
+		pxThisTask->xThresholdHeld = pdFALSE;
+		xTaskResumeAll();
+
+		if( uxTaskPriorityGet( NULL ) != pxThisTask->uxThreshold )
+		{
+			vTaskPrioritySet( NULL, pxThisTask->uxThreshold );
+		}
+	}
+#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
 
 /* The whole function code that is executed by every periodic task.
  * This function wraps the task code specified by the user. */
 static void prvPeriodicTaskCode( void *pvParameters )
 {
- 
-	SchedTCB_t *pxThisTask;	
-	TaskHandle_t xCurrentTaskHandle = xTaskGetCurrentTaskHandle();  
-	
-    /* your implementation goes here */
-    
-    /* Check the handle is not NULL. */
-    configASSERT(xCurrentTaskHandle != NULL)
-    BaseType_t xIndex = prvGetTCBIndexFromHandle(xCurrentTaskHandle);
-	if(xIndex < 0){
-		Serial.print("Invalid index\n");
-		Serial.flush();
+	/* The extended TCB is handed over as task parameter on creation. */
+	SchedTCB_t *pxThisTask = ( SchedTCB_t * ) pvParameters;
+	configASSERT( pxThisTask != NULL );
+
+	/* xLastWakeTime holds the first release, set by prvCreateAllTasks or,
+	 * after an aborted job, by prvDeadlineMissedHook. */
+	TickType_t xNow = xTaskGetTickCount();
+	if( ( SchedTickDiff_t ) ( pxThisTask->xLastWakeTime - xNow ) > 0 )
+	{
+		xTaskDelayUntil( &xNow, pxThisTask->xLastWakeTime - xNow );
 	}
-	configASSERT(xIndex >= 0);
-	
-	pxThisTask = &xTCBArray[xIndex];
-	if( pxThisTask->xReleaseTime != 0){
-	    xTaskDelayUntil(&pxThisTask->xLastWakeTime,pxThisTask->xReleaseTime);
-	}    
 	#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
         /* your implementation goes here */
         pxThisTask->xExecutedOnce = pdTRUE;
 	#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
-    
-	if( 0 == pxThisTask->xReleaseTime )
-	{
-		pxThisTask->xLastWakeTime = xSystemStartTime;
-	}
+
+	#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
+		/* The scheduler task did not know about this deadline yet. Later
+		 * deadlines only move forward, which it handles by itself. */
+		prvSchedulerRequestWake( pxThisTask->xLastWakeTime + pxThisTask->xRelativeDeadline + 1 );
+	#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 	
 	for( ; ; )
 	{	
+		#if( schedUSE_MODES == 1 )
+			/* The server tracks its aperiodic jobs by itself. */
+			#if( schedUSE_POLLING_SERVER == 1 )
+				if( pdFALSE == pxThisTask->xIsPollingServer )
+			#endif /* schedUSE_POLLING_SERVER */
+				{
+					prvModeJobBegin( pxThisTask );
+				}
+		#endif /* schedUSE_MODES */
+		#if( schedUSE_RESOURCES == 1 )
+			prvResourceJobBegin( pxThisTask );
+		#endif /* schedUSE_RESOURCES */
+		#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			prvThresholdJobBegin( pxThisTask );
+		#endif /* schedUSE_PREEMPTION_THRESHOLDS */
         pxThisTask->xStartTime = xTaskGetTickCount();      //ps&ac
 		pxThisTask->xWorkIsDone = pdFALSE;
-		Serial.print(pxThisTask->pcName);
-		Serial.print(" - START - ");
-		Serial.print(xTaskGetTickCount());
-		Serial.print("\n");
-		Serial.flush();
-		pxThisTask->pvTaskCode( pvParameters );
-		Serial.print(pxThisTask->pcName);
-		Serial.print(" - END - ");
-		Serial.print(xTaskGetTickCount());
-		Serial.print("\n");
-		Serial.flush();
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			pxThisTask->xJobReleaseTime = pxThisTask->xLastWakeTime;
+		#endif /* schedUSE_TASK_STATISTICS */
+		prvTraceEvent( schedTRACE_EVENT_START, pxThisTask, pxThisTask->xStartTime );
+		pxThisTask->pvTaskCode( pxThisTask->pvParameters );
+		TickType_t xEndTime = xTaskGetTickCount();
+		prvTraceEvent( schedTRACE_EVENT_END, pxThisTask, xEndTime );
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			prvStatsRecordJob( &pxThisTask->xStatsCollector, pxThisTask->xExecTimeCarry + prvGetExecTime( pxThisTask ),
+					xEndTime - pxThisTask->xJobReleaseTime, pxThisTask->xStartTime - pxThisTask->xJobReleaseTime );
+		#endif /* schedUSE_TASK_STATISTICS */
 		pxThisTask->xWorkIsDone = pdTRUE;
-		pxThisTask->xExecTime = 0;  
+		prvResetExecTime( pxThisTask );
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			pxThisTask->xExecTimeCarry = 0;
+		#endif /* schedUSE_TASK_STATISTICS */
+		#if( schedUSE_MODES == 1 )
+			#if( schedUSE_POLLING_SERVER == 1 )
+				if( pdFALSE == pxThisTask->xIsPollingServer )
+			#endif /* schedUSE_POLLING_SERVER */
+				{
+					prvModeJobEnd( pxThisTask );
+				}
+		#endif /* schedUSE_MODES */
+
+		#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
+			if( pdTRUE == pxThisTask->xDeadlineMissed )
+			{
+				prvLateJobCompleted( pxThisTask, xTaskGetTickCount() );
+			}
+		#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+
+		#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+			/* The next job inherits its deadline now, so priorities are already
+			 * in deadline order when it is released. */
+			pxThisTask->xAbsoluteDeadline = pxThisTask->xLastWakeTime + pxThisTask->xPeriod + pxThisTask->xRelativeDeadline;
+			xTaskNotifyGive( xSchedulerHandle );
+		#endif /* schedSCHEDULING_POLICY_EDF */
+
+		#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			/* Lowering the priority here would switch to the tasks kept
+			 * waiting and back just to block. The next job start lowers it. */
+			pxThisTask->xThresholdHeld = ( uxTaskPriorityGet( NULL ) != pxThisTask->uxPriority ) ? pdTRUE : pdFALSE;
+		#endif /* schedUSE_PREEMPTION_THRESHOLDS */
         
 		xTaskDelayUntil(&pxThisTask->xLastWakeTime, pxThisTask->xPeriod);
 	}
 }
 
-/* Creates a periodic task. */
-void vSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
-		TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick )
+/* Fills a free extended TCB for a periodic task. Returns NULL if there is
+ * none. The TCB is not in pxActiveTCBs yet. */
+static SchedTCB_t *prvPeriodicTaskInit( TaskFunction_t pvTaskCode, const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, void *pvParameters,
+		UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick,
+		TickType_t xDeadlineTick, UBaseType_t uxMissPolicy )
 {
-	taskENTER_CRITICAL();
 	SchedTCB_t *pxNewTCB;
 	
 	#if( schedUSE_TCB_ARRAY == 1 )
-		BaseType_t xIndex = prvFindEmptyElementIndexTCB();
-		configASSERT( xTaskCounter < schedMAX_NUMBER_OF_PERIODIC_TASKS );
-		configASSERT( xIndex != -1 );
+		BaseType_t xIndex = prvFindEmptyElementIndexTCB( usStackDepth );
+		if( -1 == xIndex )
+		{
+			return NULL;
+		}
 		pxNewTCB = &xTCBArray[ xIndex ];	
 	#endif /* schedUSE_TCB_ARRAY */
 
@@ -273,10 +1123,12 @@ void vSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName
 	
     pxNewTCB->pvTaskCode = pvTaskCode;
 	pxNewTCB->pcName = pcName;
-	pxNewTCB->uxStackDepth = uxStackDepth;
+	pxNewTCB->usStackDepth = usStackDepth;
 	pxNewTCB->pvParameters = pvParameters;
 	pxNewTCB->uxPriority = uxPriority;
 	pxNewTCB->pxTaskHandle = pxCreatedTask;
+	/* The handle may still hold a deleted task. */
+	*pxCreatedTask = NULL;
 	pxNewTCB->xReleaseTime = xPhaseTick;
 	pxNewTCB->xPeriod = xPeriodTick;
 	
@@ -287,6 +1139,7 @@ void vSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName
 	pxNewTCB->xMaxExecTime = xMaxExecTimeTick;
 	#if( schedUSE_POLLING_SERVER == 1)
 		pxNewTCB->xIsPollingServer = pdFALSE;
+		pxNewTCB->pxServerControl = NULL;
 	#endif /* schedUSE_POLLING_SERVER */
 
 
@@ -295,14 +1148,13 @@ void vSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName
 		pxNewTCB->xInUse = pdTRUE;
 	#endif /* schedUSE_TCB_ARRAY */
 	
-	#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
-		/* member initialization */
-		pxNewTCB->xPriorityIsSet = pdFALSE;
-	#endif /* schedSCHEDULING_POLICY */
-	
 	#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
 		/* member initialization */
 		pxNewTCB->xExecutedOnce = pdFALSE;
+		pxNewTCB->uxMissPolicy = uxMissPolicy;
+		pxNewTCB->xDeadlineMissed = pdFALSE;
+	#else
+		( void ) uxMissPolicy;
 	#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 	
 	#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
@@ -310,20 +1162,183 @@ void vSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName
         pxNewTCB->xMaxExecTimeExceeded = pdFALSE;
 	#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */	
 
-	#if( schedUSE_TCB_ARRAY == 1 )
-		xTaskCounter++;	
-	#endif /* schedUSE_TCB_SORTED_LIST */
-	taskEXIT_CRITICAL();
-  //Serial.println(pxNewTCB->xMaxExecTime);
+	#if( schedUSE_TASK_STATISTICS == 1 )
+		prvStatsInit( &pxNewTCB->xStatsCollector );
+		pxNewTCB->xExecTimeCarry = 0;
+	#endif /* schedUSE_TASK_STATISTICS */
+
+	#if( schedUSE_STACK_PROFILING == 1 )
+		pxNewTCB->usStackHighWaterMark = usStackDepth;
+	#endif /* schedUSE_STACK_PROFILING */
+
+	#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+		pxNewTCB->uxThreshold = uxPriority;
+		pxNewTCB->xThresholdHeld = pdFALSE;
+	#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
+	#if( schedUSE_RESOURCES == 1 )
+		for( UBaseType_t uxResource = 0; uxResource < schedMAX_NUMBER_OF_RESOURCES; uxResource++ )
+		{
+			pxNewTCB->xCriticalSection[ uxResource ] = 0;
+		}
+		pxNewTCB->uxResourcesHeld = 0;
+	#endif /* schedUSE_RESOURCES */
+
+	#if( schedBACKGROUND_STEALS_SLACK )
+		/* Set by the analysis, available after the level was idle once. */
+		pxNewTCB->xStaticSlack = 0;
+		pxNewTCB->xSlack = 0;
+	#endif /* schedBACKGROUND_STEALS_SLACK */
+
+	#if( schedUSE_MODES == 1 )
+		prvModeParamsInit( pxNewTCB );
+	#endif /* schedUSE_MODES */
+
+	return pxNewTCB;
+}
+
+/* Creates the task of a periodic task added while the scheduler runs. The
+ * phase counts from now. Removes the task again if it cannot be created.
+ * Called with the scheduler suspended. */
+static BaseType_t prvPeriodicTaskActivate( SchedTCB_t *pxTCB )
+{
+	pxTCB->xLastWakeTime = xTaskGetTickCount() + pxTCB->xReleaseTime;
+	pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
+	#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+		/* Start with the priority of its first deadline. */
+		prvUpdatePrioritiesEDF();
+	#endif /* schedSCHEDULING_POLICY_EDF */
+
+	if( pdPASS == prvCreateTask( pxTCB ) )
+	{
+		return pdPASS;
+	}
+	prvTaskSetChanged( prvDeleteTCBFromArray( pxTCB ) );
+	return pdFAIL;
+}
+
+/* Updates priorities after the task at xPosition of pxActiveTCBs was added
+ * or removed. */
+static void prvTaskSetChanged( BaseType_t xPosition )
+{
+	#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
+		prvSetFixedPriorities( xPosition );
+		#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+			prvResponseTimeAnalysis();
+		#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+	#else
+		/* The scheduler task reorders EDF priorities on its next run. */
+		( void ) xPosition;
+	#endif /* schedSCHEDULING_POLICY */
+}
+
+/* Creates a periodic task. */
+BaseType_t xSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, void *pvParameters, UBaseType_t uxPriority,
+		TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick,
+		UBaseType_t uxMissPolicy )
+{
+	if( pdFALSE == xSchedulerStarted )
+	{
+		#if( schedUSE_TASK_TABLE == 1 )
+			xTaskTableInUse = pdFALSE;
+		#endif /* schedUSE_TASK_TABLE */
+		SchedTCB_t *pxNewTCB = prvPeriodicTaskInit( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, xPhaseTick,
+				xPeriodTick, xMaxExecTimeTick, xDeadlineTick, uxMissPolicy );
+		if( NULL == pxNewTCB )
+		{
+			return pdFAIL;
+		}
+		prvAddTCBToArray( pxNewTCB );
+		return pdPASS;
+	}
+
+	/* The scheduler task and the other periodic tasks must not run while
+	 * the index and the priorities change. The tick hook finds the task by
+	 * thread local storage, which is set once the task is complete. */
+	BaseType_t xReturn = pdFAIL;
+	vTaskSuspendAll();
+	SchedTCB_t *pxNewTCB = prvPeriodicTaskInit( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, xPhaseTick,
+			xPeriodTick, xMaxExecTimeTick, xDeadlineTick, uxMissPolicy );
+	if( pxNewTCB != NULL )
+	{
+		prvTaskSetChanged( prvAddTCBToArray( pxNewTCB ) );
+		/* Removes the TCB again if no stack is free. */
+		xReturn = prvPeriodicTaskActivate( pxNewTCB );
+	}
+	xTaskResumeAll();
+	return xReturn;
 }
 
-/* Deletes a periodic task. */
+/* Deletes a periodic task. May be called by the task itself, except with
+ * static allocation: its TCB would be reused before the idle task is done
+ * with it. */
 void vSchedulerPeriodicTaskDelete( TaskHandle_t xTaskHandle )
 {
-	BaseType_t xIndex = prvGetTCBIndexFromHandle(xTaskHandle);
-	prvDeleteTCBFromArray(xIndex);
-	
-	vTaskDelete( xTaskHandle );
+	SchedTCB_t *pxTCB = prvGetTCBFromHandle( xTaskHandle );
+	configASSERT( pxTCB != NULL );
+	#if( schedUSE_POLLING_SERVER == 1 )
+		configASSERT( pdFALSE == pxTCB->xIsPollingServer );
+	#endif /* schedUSE_POLLING_SERVER */
+
+	vTaskSuspendAll();
+	/* The handle changes when a job is aborted. */
+	TaskHandle_t xHandle = *pxTCB->pxTaskHandle;
+	BaseType_t xDeleteSelf = ( xHandle == xTaskGetCurrentTaskHandle() ) ? pdTRUE : pdFALSE;
+	#if( schedUSE_STATIC_ALLOCATION == 1 )
+		configASSERT( pdFALSE == xDeleteSelf );
+	#endif /* schedUSE_STATIC_ALLOCATION */
+
+	/* Detach the TCB first, the tick hook keeps running. */
+	vTaskSetThreadLocalStoragePointer( xHandle, schedTHREAD_LOCAL_STORAGE_POINTER_INDEX, NULL );
+	#if( schedUSE_STACK_PROFILING == 1 )
+		prvStackSample( xHandle, &pxTCB->usStackHighWaterMark );
+	#endif /* schedUSE_STACK_PROFILING */
+	#if( schedUSE_RESOURCES == 1 )
+		prvResourceReleaseAll( pxTCB );
+	#endif /* schedUSE_RESOURCES */
+	prvTaskSetChanged( prvDeleteTCBFromArray( pxTCB ) );
+	if( pdFALSE == xDeleteSelf )
+	{
+		vTaskDelete( xHandle );
+	}
+	xTaskResumeAll();
+
+	if( pdTRUE == xDeleteSelf )
+	{
+		vTaskDelete( NULL );
+	}
+}
+
+/* Creates the FreeRTOS task of a periodic task and attaches its extended
+ * TCB. With static allocation the stack is taken from xStackPool only if
+ * the stack the TCB holds is too small. */
+static BaseType_t prvCreateTask( SchedTCB_t *pxTCB )
+{
+	BaseType_t xReturnValue;
+
+	#if( schedUSE_STATIC_ALLOCATION == 1 )
+		if( pxTCB->usStackBufferDepth < pxTCB->usStackDepth )
+		{
+			if( xStackPoolUsed + pxTCB->usStackDepth > schedSTATIC_STACK_POOL_SIZE )
+			{
+				return pdFAIL;
+			}
+			pxTCB->puxStackBuffer = &xStackPool[ xStackPoolUsed ];
+			pxTCB->usStackBufferDepth = pxTCB->usStackDepth;
+			xStackPoolUsed += pxTCB->usStackDepth;
+		}
+		*pxTCB->pxTaskHandle = xTaskCreateStatic( prvPeriodicTaskCode, pxTCB->pcName, pxTCB->usStackDepth, pxTCB, pxTCB->uxPriority,
+				pxTCB->puxStackBuffer, &pxTCB->xTaskBuffer );
+		xReturnValue = ( *pxTCB->pxTaskHandle != NULL ) ? pdPASS : pdFAIL;
+	#else
+		xReturnValue = xTaskCreate( prvPeriodicTaskCode, pxTCB->pcName, pxTCB->usStackDepth, pxTCB, pxTCB->uxPriority, pxTCB->pxTaskHandle );
+	#endif /* schedUSE_STATIC_ALLOCATION */
+
+	if( pdPASS == xReturnValue )
+	{
+		vTaskSetThreadLocalStoragePointer( *pxTCB->pxTaskHandle, schedTHREAD_LOCAL_STORAGE_POINTER_INDEX, pxTCB );
+	}
+	return xReturnValue;
 }
 
 /* Creates all periodic tasks stored in TCB array, or TCB list. */
@@ -333,11 +1348,22 @@ static void prvCreateAllTasks( void )
 
 	#if( schedUSE_TCB_ARRAY == 1 )
 		BaseType_t xIndex;
-		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		/* In the order the tasks were created. */
+		for( xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++ )
 		{
-			configASSERT( pdTRUE == xTCBArray[ xIndex ].xInUse );
 			pxTCB = &xTCBArray[ xIndex ];
-			BaseType_t xReturnValue = xTaskCreate(prvPeriodicTaskCode,pxTCB->pcName,pxTCB->uxStackDepth,pxTCB->pvParameters,pxTCB->uxPriority,pxTCB->pxTaskHandle);
+			if( pdFALSE == pxTCB->xInUse )
+			{
+				continue;
+			}
+			#if( schedUSE_MODES == 1 )
+				if( pdFALSE == prvIsInMode( pxTCB, uxCurrentMode ) )
+				{
+					continue;
+				}
+			#endif /* schedUSE_MODES */
+			pxTCB->xLastWakeTime = xSystemStartTime + pxTCB->xReleaseTime;
+			BaseType_t xReturnValue = prvCreateTask( pxTCB );
 			if(xReturnValue == pdPASS) {
 				Serial.print(pxTCB->pcName);
 				Serial.print(", Period- ");
@@ -346,10 +1372,25 @@ static void prvCreateAllTasks( void )
 				Serial.print(pxTCB->xReleaseTime);
 				Serial.print(", Priority- ");
 				Serial.print(pxTCB->uxPriority);				
+				#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+					Serial.print(", Threshold- ");
+					Serial.print(pxTCB->uxThreshold);
+				#endif /* schedUSE_PREEMPTION_THRESHOLDS */
 				Serial.print(", WCET- ");
 				Serial.print(pxTCB->xMaxExecTime);
 				Serial.print(", Deadline- ");
 				Serial.print(pxTCB->xRelativeDeadline);
+				#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+					Serial.print(", WCRT- ");
+					if( portMAX_DELAY == pxTCB->xResponseTime )
+					{
+						Serial.print("unschedulable");
+					}
+					else
+					{
+						Serial.print(pxTCB->xResponseTime);
+					}
+				#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
 				Serial.println();
 				Serial.flush();
 			}
@@ -362,54 +1403,1013 @@ static void prvCreateAllTasks( void )
 	#endif /* schedUSE_TCB_ARRAY */
 }
 
-#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS  || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
-	/* Initiazes fixed priorities of all periodic tasks with respect to RMS policy. */
-static void prvSetFixedPriorities( void )
+#if( schedUSE_MODES == 1 )
+	/* Makes the current parameters of pxTCB its parameters in every mode. */
+	static void prvModeParamsInit( SchedTCB_t *pxTCB )
+	{
+		UBaseType_t uxMode;
+
+		for( uxMode = 0; uxMode < schedMAX_NUMBER_OF_MODES; uxMode++ )
+		{
+			pxTCB->xModeParams[ uxMode ].xPeriod = pxTCB->xPeriod;
+			pxTCB->xModeParams[ uxMode ].xMaxExecTime = pxTCB->xMaxExecTime;
+			pxTCB->xModeParams[ uxMode ].xRelativeDeadline = pxTCB->xRelativeDeadline;
+		}
+		pxTCB->xJobInProgress = pdFALSE;
+	}
+
+	/* Returns pdTRUE if pxTCB takes part in mode uxMode. */
+	static BaseType_t prvIsInMode( const SchedTCB_t *pxTCB, UBaseType_t uxMode )
+	{
+		return ( pxTCB->xModeParams[ uxMode ].xPeriod > 0 ) ? pdTRUE : pdFALSE;
+	}
+
+	/* Rebuilds pxActiveTCBs from the tasks of mode uxMode, with the
+	 * parameters of that mode. Tasks are added in the order they were
+	 * created, so the server comes first as before. The tick hook sees the
+	 * old index or the new one, never a part of it. */
+	static void prvModeEnter( UBaseType_t uxMode )
+	{
+		BaseType_t xIndex;
+
+		taskENTER_CRITICAL();
+		xTaskCounter = 0;
+		for( xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++ )
+		{
+			SchedTCB_t *pxTCB = &xTCBArray[ xIndex ];
+			if( pdTRUE == pxTCB->xInUse && pdTRUE == prvIsInMode( pxTCB, uxMode ) )
+			{
+				pxTCB->xPeriod = pxTCB->xModeParams[ uxMode ].xPeriod;
+				pxTCB->xMaxExecTime = pxTCB->xModeParams[ uxMode ].xMaxExecTime;
+				pxTCB->xRelativeDeadline = pxTCB->xModeParams[ uxMode ].xRelativeDeadline;
+				prvAddTCBToArray( pxTCB );
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	/* Marks the start of a job. While a mode change is pending no job is
+	 * started, the task waits for the change to delete it. */
+	static void prvModeJobBegin( SchedTCB_t *pxTCB )
+	{
+		pxTCB->xJobInProgress = pdTRUE;
+		if( pdTRUE == xModeChangePending )
+		{
+			prvModeJobEnd( pxTCB );
+			for( ; ; )
+			{
+				vTaskSuspend( NULL );
+			}
+		}
+	}
+
+	/* Marks the end of a job. The last job of a pending mode change wakes
+	 * the scheduler task. */
+	static void prvModeJobEnd( SchedTCB_t *pxTCB )
+	{
+		pxTCB->xJobInProgress = pdFALSE;
+		if( pdTRUE == xModeChangePending )
+		{
+			xTaskNotifyGive( xSchedulerHandle );
+		}
+	}
+
+	/* Deletes the task of pxTCB. The extended TCB is kept for later modes. */
+	static void prvModeTaskStop( SchedTCB_t *pxTCB )
+	{
+		TaskHandle_t xHandle = *pxTCB->pxTaskHandle;
+
+		if( NULL == xHandle )
+		{
+			return;
+		}
+		#if( schedUSE_STACK_PROFILING == 1 )
+			prvStackSample( xHandle, &pxTCB->usStackHighWaterMark );
+		#endif /* schedUSE_STACK_PROFILING */
+		/* The tick hook follows thread local storage and the server handle. */
+		taskENTER_CRITICAL();
+		vTaskSetThreadLocalStoragePointer( xHandle, schedTHREAD_LOCAL_STORAGE_POINTER_INDEX, NULL );
+		*pxTCB->pxTaskHandle = NULL;
+		taskEXIT_CRITICAL();
+		vTaskDelete( xHandle );
+	}
+
+	/* Changes to the requested mode if no job is in progress. Called by the
+	 * scheduler task, so no task of the old mode runs meanwhile. */
+	static void prvModeChangeApply( void )
+	{
+		BaseType_t xIndex;
+
+		vTaskSuspendAll();
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			if( pdTRUE == pxActiveTCBs[ xIndex ]->xJobInProgress )
+			{
+				/* Woken again when the job completes. */
+				xTaskResumeAll();
+				return;
+			}
+		}
+
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			prvModeTaskStop( pxActiveTCBs[ xIndex ] );
+		}
+		uxCurrentMode = uxRequestedMode;
+		prvModeEnter( uxCurrentMode );
+
+		/* All tasks of the new mode are released from now on, as if the
+		 * scheduler had been started now. */
+		TickType_t xTickCount = xTaskGetTickCount();
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+			pxTCB->xLastWakeTime = xTickCount + pxTCB->xReleaseTime;
+			pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
+			pxTCB->xWorkIsDone = pdFALSE;
+			prvResetExecTime( pxTCB );
+			#if( schedUSE_TASK_STATISTICS == 1 )
+				pxTCB->xExecTimeCarry = 0;
+			#endif /* schedUSE_TASK_STATISTICS */
+			#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
+				pxTCB->xExecutedOnce = pdFALSE;
+				pxTCB->xDeadlineMissed = pdFALSE;
+			#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+			#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+				pxTCB->xSuspended = pdFALSE;
+				pxTCB->xMaxExecTimeExceeded = pdFALSE;
+			#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+			#if( schedUSE_POLLING_SERVER == 1 && schedUSE_SPORADIC_SERVER == 1 )
+				if( pdTRUE == pxTCB->xIsPollingServer )
+				{
+					/* The server starts with its full budget. */
+					taskENTER_CRITICAL();
+					pxTCB->xChunkActive = pdFALSE;
+					pxTCB->pxServerControl->uxReplenishmentFirst = 0;
+					pxTCB->pxServerControl->uxReplenishmentCounter = 0;
+					taskEXIT_CRITICAL();
+				}
+			#endif /* schedUSE_SPORADIC_SERVER */
+		}
+
+		#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
+			prvTaskSetChanged( 0 );
+		#elif( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+			prvUpdatePrioritiesEDF();
+		#endif /* schedSCHEDULING_POLICY */
+
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			if( pdFAIL == prvCreateTask( pxActiveTCBs[ xIndex ] ) )
+			{
+				Serial.println("Task creation failed\n");
+				Serial.flush();
+			}
+		}
+		xModeChangePending = pdFALSE;
+		xTaskResumeAll();
+	}
+
+	/* Sets the parameters of pxTCB in mode uxMode. */
+	static void prvModeSetParams( SchedTCB_t *pxTCB, UBaseType_t uxMode, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick )
+	{
+		configASSERT( uxMode < schedMAX_NUMBER_OF_MODES );
+		configASSERT( pdFALSE == xSchedulerStarted || uxMode != uxCurrentMode );
+		#if( schedUSE_TASK_TABLE == 1 )
+			if( uxMode == uxCurrentMode )
+			{
+				xTaskTableInUse = pdFALSE;
+			}
+		#endif /* schedUSE_TASK_TABLE */
+
+		/* The scheduler task reads them when it changes the mode. */
+		if( pdTRUE == xSchedulerStarted )
+		{
+			vTaskSuspendAll();
+		}
+		pxTCB->xModeParams[ uxMode ].xPeriod = xPeriodTick;
+		pxTCB->xModeParams[ uxMode ].xMaxExecTime = xMaxExecTimeTick;
+		pxTCB->xModeParams[ uxMode ].xRelativeDeadline = xDeadlineTick;
+		if( pdTRUE == xSchedulerStarted )
+		{
+			xTaskResumeAll();
+		}
+	}
+
+	/* Creates or renames a mode. */
+	void vSchedulerModeCreate( UBaseType_t uxMode, const char *pcName )
+	{
+		configASSERT( uxMode < schedMAX_NUMBER_OF_MODES && pcName != NULL );
+		pcModeNames[ uxMode ] = pcName;
+	}
+
+	/* Sets the parameters of a periodic task in a mode. */
+	void vSchedulerModeSetTask( UBaseType_t uxMode, TaskHandle_t *pxCreatedTask, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick,
+			TickType_t xDeadlineTick )
+	{
+		SchedTCB_t *pxTCB = prvFindTCBByHandlePointer( pxCreatedTask );
+		configASSERT( pxTCB != NULL );
+		prvModeSetParams( pxTCB, uxMode, xPeriodTick, xMaxExecTimeTick, xDeadlineTick );
+	}
+
+	#if( schedUSE_POLLING_SERVER == 1 )
+		/* Sets the parameters of a server in a mode. */
+		void vSchedulerModeSetServer( UBaseType_t uxMode, UBaseType_t uxServer, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick,
+				TickType_t xDeadlineTick )
+		{
+			configASSERT( xPeriodTick > 0 && uxServer < uxServerCounter );
+			prvModeSetParams( xServerArray[ uxServer ].pxTCB, uxMode, xPeriodTick, xMaxExecTimeTick, xDeadlineTick );
+		}
+	#endif /* schedUSE_POLLING_SERVER */
+
+	/* Requests a mode change, which the scheduler task carries out. */
+	BaseType_t xSchedulerModeChange( UBaseType_t uxMode )
+	{
+		BaseType_t xReturn = pdFAIL;
+
+		if( uxMode >= schedMAX_NUMBER_OF_MODES || NULL == pcModeNames[ uxMode ] )
+		{
+			return pdFAIL;
+		}
+
+		if( pdFALSE == xSchedulerStarted )
+		{
+			#if( schedUSE_TASK_TABLE == 1 )
+				if( uxMode != uxCurrentMode )
+				{
+					xTaskTableInUse = pdFALSE;
+				}
+			#endif /* schedUSE_TASK_TABLE */
+			uxCurrentMode = uxMode;
+			return pdPASS;
+		}
+
+		taskENTER_CRITICAL();
+		if( pdFALSE == xModeChangePending )
+		{
+			uxRequestedMode = uxMode;
+			xModeChangePending = pdTRUE;
+			xReturn = pdPASS;
+		}
+		taskEXIT_CRITICAL();
+
+		if( pdPASS == xReturn )
+		{
+			xTaskNotifyGive( xSchedulerHandle );
+		}
+		return xReturn;
+	}
+
+	/* Returns the current mode. */
+	UBaseType_t uxSchedulerGetMode( void )
+	{
+		return uxCurrentMode;
+	}
+
+	/* Returns the name of a mode. */
+	const char *pcSchedulerGetModeName( UBaseType_t uxMode )
+	{
+		return ( uxMode < schedMAX_NUMBER_OF_MODES ) ? pcModeNames[ uxMode ] : NULL;
+	}
+
+	#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+		/* Returns the longest time a mode change requested now can take. Every
+		 * job in progress completes within its response time. */
+		TickType_t xSchedulerModeChangeLatency( void )
+		{
+			TickType_t xLatency = 0;
+			BaseType_t xIndex;
+
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				if( pxActiveTCBs[ xIndex ]->xResponseTime > xLatency )
+				{
+					xLatency = pxActiveTCBs[ xIndex ]->xResponseTime;
+				}
+			}
+			return xLatency;
+		}
+	#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+#endif /* schedUSE_MODES */
+
+#if( schedUSE_RESOURCES == 1 )
+	/* Returns the priority pxTCB runs at with the resources it holds. */
+	static UBaseType_t prvResourcePriority( const SchedTCB_t *pxTCB )
+	{
+		#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			UBaseType_t uxPriority = pxTCB->uxThreshold;
+		#else
+			UBaseType_t uxPriority = pxTCB->uxPriority;
+		#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
+		for( UBaseType_t uxResource = 0; uxResource < uxResourceCounter; uxResource++ )
+		{
+			if( ( pxTCB->uxResourcesHeld & ( 1U << uxResource ) ) != 0 && xResourceArray[ uxResource ].uxCeiling > uxPriority )
+			{
+				uxPriority = xResourceArray[ uxResource ].uxCeiling;
+			}
+		}
+		return uxPriority;
+	}
+
+	/* Sets the ceilings from the priorities of the current users. A task in a
+	 * critical section is raised to the new ceiling at once. */
+	static void prvResourceUpdateCeilings( void )
+	{
+		BaseType_t xIndex;
+
+		for( UBaseType_t uxResource = 0; uxResource < uxResourceCounter; uxResource++ )
+		{
+			UBaseType_t uxCeiling = schedLOWEST_TASK_PRIORITY;
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				if( pxActiveTCBs[ xIndex ]->xCriticalSection[ uxResource ] > 0 && pxActiveTCBs[ xIndex ]->uxPriority > uxCeiling )
+				{
+					uxCeiling = pxActiveTCBs[ xIndex ]->uxPriority;
+				}
+			}
+			xResourceArray[ uxResource ].uxCeiling = uxCeiling;
+		}
+
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+			if( pxTCB->uxResourcesHeld != 0 && *pxTCB->pxTaskHandle != NULL )
+			{
+				vTaskPrioritySet( *pxTCB->pxTaskHandle, prvResourcePriority( pxTCB ) );
+			}
+		}
+	}
+
+	/* Frees the resources of a task whose job is aborted or deleted. */
+	static void prvResourceReleaseAll( SchedTCB_t *pxTCB )
+	{
+		for( UBaseType_t uxResource = 0; uxResource < uxResourceCounter; uxResource++ )
+		{
+			if( xResourceArray[ uxResource ].pxHolder == pxTCB )
+			{
+				xResourceArray[ uxResource ].pxHolder = NULL;
+			}
+		}
+		pxTCB->uxResourcesHeld = 0;
+	}
+
+	/* FreeRTOS time slices tasks of equal priority, so a job released at the
+	 * ceiling of a resource held by another task would run beside the
+	 * holder. It gives the CPU back until the resource is free, which holds
+	 * only as long as holders do not block in critical sections. */
+	static void prvResourceJobBegin( const SchedTCB_t *pxThisTask )
+	{
+		UBaseType_t uxResource = 0;
+
+		while( uxResource < uxResourceCounter )
+		{
+			if( xResourceArray[ uxResource ].pxHolder != NULL && xResourceArray[ uxResource ].pxHolder != pxThisTask &&
+					xResourceArray[ uxResource ].uxCeiling >= pxThisTask->uxPriority )
+			{
+				taskYIELD();
+				uxResource = 0;
+			}
+			else
+			{
+				uxResource++;
+			}
+		}
+	}
+
+	BaseType_t xSchedulerResourceCreate( const char *pcName )
+	{
+		configASSERT( pdFALSE == xSchedulerStarted );
+		if( uxResourceCounter >= schedMAX_NUMBER_OF_RESOURCES )
+		{
+			return -1;
+		}
+		xResourceArray[ uxResourceCounter ].pcName = pcName;
+		xResourceArray[ uxResourceCounter ].uxCeiling = schedLOWEST_TASK_PRIORITY;
+		xResourceArray[ uxResourceCounter ].pxHolder = NULL;
+		return ( BaseType_t ) uxResourceCounter++;
+	}
+
+	void vSchedulerResourceUse( UBaseType_t uxResource, TaskHandle_t *pxCreatedTask, TickType_t xCriticalSectionTick )
+	{
+		SchedTCB_t *pxTCB = prvFindTCBByHandlePointer( pxCreatedTask );
+		configASSERT( pdFALSE == xSchedulerStarted && uxResource < uxResourceCounter && pxTCB != NULL && xCriticalSectionTick > 0 );
+		pxTCB->xCriticalSection[ uxResource ] = xCriticalSectionTick;
+	}
+
+	/* No other user can run while the resource is held, it is always free. */
+	void vSchedulerResourceTake( UBaseType_t uxResource )
+	{
+		SchedTCB_t *pxTCB = prvGetTCBFromHandle( NULL );
+		configASSERT( uxResource < uxResourceCounter && pxTCB != NULL && pxTCB->xCriticalSection[ uxResource ] > 0 );
+		configASSERT( NULL == xResourceArray[ uxResource ].pxHolder );
+
+		xResourceArray[ uxResource ].pxHolder = pxTCB;
+		pxTCB->uxResourcesHeld |= ( 1U << uxResource );
+		if( xResourceArray[ uxResource ].uxCeiling > uxTaskPriorityGet( NULL ) )
+		{
+			vTaskPrioritySet( NULL, xResourceArray[ uxResource ].uxCeiling );
+		}
+	}
+
+	void vSchedulerResourceGive( UBaseType_t uxResource )
+	{
+		SchedTCB_t *pxTCB = prvGetTCBFromHandle( NULL );
+		configASSERT( uxResource < uxResourceCounter && pxTCB != NULL && xResourceArray[ uxResource ].pxHolder == pxTCB );
+
+		xResourceArray[ uxResource ].pxHolder = NULL;
+		pxTCB->uxResourcesHeld &= ~( 1U << uxResource );
+		#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+			/* The scheduler task suspends the overrun job before others run. */
+			if( 0 == pxTCB->uxResourcesHeld && pdTRUE == pxTCB->xMaxExecTimeExceeded )
+			{
+				xTaskNotifyGive( xSchedulerHandle );
+			}
+		#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+		UBaseType_t uxPriority = prvResourcePriority( pxTCB );
+		if( uxPriority != uxTaskPriorityGet( NULL ) )
+		{
+			vTaskPrioritySet( NULL, uxPriority );
+		}
+	}
+
+	UBaseType_t uxSchedulerGetResourceCeiling( UBaseType_t uxResource )
+	{
+		configASSERT( uxResource < uxResourceCounter );
+		return xResourceArray[ uxResource ].uxCeiling;
+	}
+#endif /* schedUSE_RESOURCES */
+
+#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS  || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
+	/* Assigns fixed priorities to the tasks from position xFrom of
+	 * pxActiveTCBs on. The index is kept in RMS or DMS order, so tasks before
+	 * xFrom keep their priority. Tasks that already run are updated. */
+static void prvSetFixedPriorities( BaseType_t xFrom )
 {
-	BaseType_t xIter, xIndex;
-	TickType_t xShortest, xPreviousShortest=0;
-	SchedTCB_t *pxShortestTaskPointer, *pxTCB;
+	BaseType_t xIndex;
 
-	#if( schedUSE_SCHEDULER_TASK == 1 )
-		BaseType_t xHighestPriority = schedSCHEDULER_PRIORITY; 
-	#else
-		BaseType_t xHighestPriority = configMAX_PRIORITIES;
-	#endif /* schedUSE_SCHEDULER_TASK */
+	BaseType_t xHighestPriority = schedHIGHEST_TASK_PRIORITY;
+
+	for( xIndex = xFrom; xIndex < xTaskCounter; xIndex++ )
+	{
+		SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+		UBaseType_t uxPriority = ( xIndex * schedPRIORITY_STRIDE < xHighestPriority - schedLOWEST_TASK_PRIORITY ) ?
+				xHighestPriority - xIndex * schedPRIORITY_STRIDE : schedLOWEST_TASK_PRIORITY;
+
+		if( pxTCB->uxPriority != uxPriority )
+		{
+			pxTCB->uxPriority = uxPriority;
+			/* Tasks are not created yet when called from vSchedulerStart. */
+			if( *pxTCB->pxTaskHandle != NULL )
+			{
+				vTaskPrioritySet( *pxTCB->pxTaskHandle, uxPriority );
+			}
+			#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+				/* The worker runs jobs at the server's priority. */
+				if( pdTRUE == pxTCB->xIsPollingServer && pxTCB->pxServerControl->xAperiodicWorkerHandle != NULL )
+				{
+					vTaskPrioritySet( pxTCB->pxServerControl->xAperiodicWorkerHandle, uxPriority );
+				}
+			#endif /* schedUSE_APERIODIC_WORKER_TASK */
+		}
+	}
+
+	#if( schedUSE_RESOURCES == 1 )
+		prvResourceUpdateCeilings();
+	#endif /* schedUSE_RESOURCES */
+}
+
+#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+	/* A Deferrable Server can run its budget back to back across a period
+	 * boundary, which is modelled as release jitter of its period minus its
+	 * budget. Other tasks have no jitter. */
+	static TickType_t prvReleaseJitter( const SchedTCB_t *pxTCB )
+	{
+		#if( schedUSE_POLLING_SERVER == 1 && schedUSE_DEFERRABLE_SERVER == 1 )
+			if( pdTRUE == pxTCB->xIsPollingServer )
+			{
+				return pxTCB->xPeriod - pxTCB->xMaxExecTime;
+			}
+		#else
+			( void ) pxTCB;
+		#endif /* schedUSE_DEFERRABLE_SERVER */
+		return 0;
+	}
+
+	/* Returns the number of jobs of pxTCB released before xTime, counted from
+	 * a release of all tasks at time 0. */
+	static TickType_t prvReleasesBefore( const SchedTCB_t *pxTCB, TickType_t xTime )
+	{
+		return ( xTime + prvReleaseJitter( pxTCB ) + pxTCB->xPeriod - 1 ) / pxTCB->xPeriod;
+	}
+
+	/* Returns the number of jobs of pxTCB released up to and including xTime. */
+	static TickType_t prvReleasesUpTo( const SchedTCB_t *pxTCB, TickType_t xTime )
+	{
+		return ( xTime + prvReleaseJitter( pxTCB ) ) / pxTCB->xPeriod + 1;
+	}
+
+	/* Returns the priority a started job of pxTCB runs at. */
+	static UBaseType_t prvPreemptionThreshold( const SchedTCB_t *pxTCB )
+	{
+		#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			return pxTCB->uxThreshold;
+		#else
+			return pxTCB->uxPriority;
+		#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+	}
+
+	/* Returns the longest time a job of pxTCB can wait for a job of lower
+	 * priority that has started at a threshold of at least its priority, or
+	 * that holds a resource with a ceiling of at least its priority. */
+	static TickType_t prvBlocking( const SchedTCB_t *pxTCB )
+	{
+		TickType_t xBlocking = 0;
+		BaseType_t xIndex;
+
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			const SchedTCB_t *pxOther = pxActiveTCBs[ xIndex ];
+			if( pxOther->uxPriority >= pxTCB->uxPriority )
+			{
+				continue;
+			}
+			if( prvPreemptionThreshold( pxOther ) >= pxTCB->uxPriority && pxOther->xMaxExecTime > xBlocking )
+			{
+				xBlocking = pxOther->xMaxExecTime;
+			}
+			#if( schedUSE_RESOURCES == 1 )
+				for( UBaseType_t uxResource = 0; uxResource < uxResourceCounter; uxResource++ )
+				{
+					if( xResourceArray[ uxResource ].uxCeiling >= pxTCB->uxPriority && pxOther->xCriticalSection[ uxResource ] > xBlocking )
+					{
+						xBlocking = pxOther->xCriticalSection[ uxResource ];
+					}
+				}
+			#endif /* schedUSE_RESOURCES */
+		}
+		return xBlocking;
+	}
+
+	/* Returns the worst-case execution time that tasks of higher or equal
+	 * priority can demand within xWindow ticks after the release of pxTCB.
+	 * Equal priorities interfere because they share time slices. */
+	static TickType_t prvInterference( const SchedTCB_t *pxTCB, TickType_t xWindow )
+	{
+		TickType_t xDemand = 0;
+		BaseType_t xIndex;
+
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			const SchedTCB_t *pxOther = pxActiveTCBs[ xIndex ];
+			if( pxOther == pxTCB || pxOther->uxPriority < pxTCB->uxPriority )
+			{
+				continue;
+			}
+
+			xDemand += prvReleasesBefore( pxOther, xWindow ) * pxOther->xMaxExecTime;
+		}
+		return xDemand;
+	}
+
+	/* Returns when job xJob of pxTCB completes, counted from the start of its
+	 * level-i busy period, or portMAX_DELAY as soon as it can miss its
+	 * deadline. Until the job starts, every task of higher or equal priority
+	 * released so far runs first. Once started, only tasks at or above its
+	 * preemption threshold preempt it. Without thresholds this is the
+	 * classic w = B + ( q + 1 ) C + I( w ). */
+	static TickType_t prvFinishTime( const SchedTCB_t *pxTCB, TickType_t xBlocking, TickType_t xJob )
+	{
+		TickType_t xLimit = xJob * pxTCB->xPeriod + pxTCB->xRelativeDeadline;
+		UBaseType_t uxThreshold = prvPreemptionThreshold( pxTCB );
+		TickType_t xStart, xFinish, xNext;
+		BaseType_t xIndex;
+
+		/* s = B + q C + sum over hep( i ) of ( 1 + floor( s / T ) ) C. */
+		xNext = xBlocking + xJob * pxTCB->xMaxExecTime;
+		do
+		{
+			xStart = xNext;
+			if( xStart + pxTCB->xMaxExecTime > xLimit )
+			{
+				return portMAX_DELAY;
+			}
+			xNext = xBlocking + xJob * pxTCB->xMaxExecTime;
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				const SchedTCB_t *pxOther = pxActiveTCBs[ xIndex ];
+				if( pxOther != pxTCB && pxOther->uxPriority >= pxTCB->uxPriority )
+				{
+					xNext += prvReleasesUpTo( pxOther, xStart ) * pxOther->xMaxExecTime;
+				}
+			}
+		} while( xNext != xStart );
+
+		/* f = s + C + jobs released in ( s, f ) above the threshold. */
+		xNext = xStart + pxTCB->xMaxExecTime;
+		do
+		{
+			xFinish = xNext;
+			if( xFinish > xLimit )
+			{
+				return portMAX_DELAY;
+			}
+			xNext = xStart + pxTCB->xMaxExecTime;
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				const SchedTCB_t *pxOther = pxActiveTCBs[ xIndex ];
+				if( pxOther != pxTCB && pxOther->uxPriority >= uxThreshold )
+				{
+					xNext += ( prvReleasesBefore( pxOther, xFinish ) - prvReleasesUpTo( pxOther, xStart ) ) * pxOther->xMaxExecTime;
+				}
+			}
+		} while( xNext != xFinish );
+
+		return xFinish;
+	}
+
+	/* Returns the worst-case response time of pxTCB when it is blocked for
+	 * xBlocking ticks at most per busy period, or portMAX_DELAY as soon as a
+	 * job can miss its deadline. Jobs released in the level-i busy period
+	 * are checked one by one, so deadlines beyond the period are handled
+	 * exactly as well. */
+	static TickType_t prvResponseTime( const SchedTCB_t *pxTCB, TickType_t xBlocking )
+	{
+		TickType_t xResponseTime = 0;
+		TickType_t xBusyPeriod = 0;
+		TickType_t xJob;
+
+		for( xJob = 0; ; xJob++ )
+		{
+			TickType_t xRelease = xJob * pxTCB->xPeriod;
+			TickType_t xFinish = prvFinishTime( pxTCB, xBlocking, xJob );
+			if( portMAX_DELAY == xFinish )
+			{
+				return portMAX_DELAY;
+			}
+			if( xFinish - xRelease > xResponseTime )
+			{
+				xResponseTime = xFinish - xRelease;
+			}
+
+			/* The busy period ends before the next release. It lasts at
+			 * least until the job completes. */
+			TickType_t xNext = ( xFinish > xBusyPeriod ) ? xFinish : xBusyPeriod;
+			do
+			{
+				xBusyPeriod = xNext;
+				xNext = xBlocking + ( xJob + 1 ) * pxTCB->xMaxExecTime + prvInterference( pxTCB, xBusyPeriod );
+			} while( xNext != xBusyPeriod && xNext <= xRelease + pxTCB->xPeriod );
+			if( xNext <= xRelease + pxTCB->xPeriod )
+			{
+				return xResponseTime;
+			}
+		}
+	}
+
+	/* Computes the response time of every periodic task with the priorities
+	 * and thresholds assigned so far. Returns pdFAIL if any task can miss
+	 * its deadline. */
+	static BaseType_t prvResponseTimes( void )
+	{
+		BaseType_t xReturn = pdPASS;
+		BaseType_t xIndex;
+
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+			pxTCB->xResponseTime = prvResponseTime( pxTCB, prvBlocking( pxTCB ) );
+			if( portMAX_DELAY == pxTCB->xResponseTime )
+			{
+				xReturn = pdFAIL;
+			}
+		}
+		return xReturn;
+	}
+
+	#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+		/* Returns pdTRUE if a task other than pxTCB runs at uxLevel. */
+		static BaseType_t prvPriorityLevelTaken( const SchedTCB_t *pxTCB, UBaseType_t uxLevel )
+		{
+			BaseType_t xIndex;
+
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				if( pxActiveTCBs[ xIndex ] != pxTCB && pxActiveTCBs[ xIndex ]->uxPriority == uxLevel )
+				{
+					return pdTRUE;
+				}
+			}
+			return pdFALSE;
+		}
+
+		/* Raises the threshold of every periodic task, highest priority
+		 * first, as long as the whole set stays schedulable. Levels of other
+		 * tasks are passed over, a job there would share time slices with
+		 * them. Servers keep their priority. Leaves the response times of
+		 * the final thresholds behind. */
+		static void prvAssignPreemptionThresholds( void )
+		{
+			BaseType_t xIndex;
+
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+				UBaseType_t uxAccepted = pxTCB->uxThreshold;
+				#if( schedUSE_POLLING_SERVER == 1 )
+					if( pdTRUE == pxTCB->xIsPollingServer )
+					{
+						continue;
+					}
+				#endif /* schedUSE_POLLING_SERVER */
+				while( pxTCB->uxThreshold < schedHIGHEST_TASK_PRIORITY && pxTCB->uxThreshold < configMAX_PRIORITIES - 1 )
+				{
+					pxTCB->uxThreshold++;
+					if( pdTRUE == prvPriorityLevelTaken( pxTCB, pxTCB->uxThreshold ) )
+					{
+						continue;
+					}
+					if( pdFAIL == prvResponseTimes() )
+					{
+						break;
+					}
+					uxAccepted = pxTCB->uxThreshold;
+				}
+				pxTCB->uxThreshold = uxAccepted;
+			}
+			prvResponseTimes();
+		}
+	#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
+	/* Computes the response time of every periodic task with the priorities
+	 * assigned by prvSetFixedPriorities, after choosing preemption thresholds
+	 * if enabled. Returns pdFAIL if any task can miss its deadline. */
+	static BaseType_t prvResponseTimeAnalysis( void )
+	{
+		BaseType_t xReturn;
+
+		#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			/* Thresholds start over from the priorities. */
+			for( BaseType_t xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				pxActiveTCBs[ xIndex ]->uxThreshold = pxActiveTCBs[ xIndex ]->uxPriority;
+			}
+		#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
+		xReturn = prvResponseTimes();
+
+		#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			if( pdPASS == xReturn )
+			{
+				prvAssignPreemptionThresholds();
+			}
+		#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
+		#if( schedBACKGROUND_STEALS_SLACK )
+			/* No slack is stolen while any task can miss its deadline. */
+			for( BaseType_t xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+				TickType_t xStaticSlack = ( pdPASS == xReturn ) ? prvStaticSlack( pxTCB ) : 0;
+				taskENTER_CRITICAL();
+				pxTCB->xStaticSlack = xStaticSlack;
+				if( pxTCB->xSlack > xStaticSlack )
+				{
+					pxTCB->xSlack = xStaticSlack;
+				}
+				taskEXIT_CRITICAL();
+			}
+		#endif /* schedBACKGROUND_STEALS_SLACK */
+		return xReturn;
+	}
+
+	#if( schedBACKGROUND_STEALS_SLACK )
+		/* Returns how much time can be stolen at a higher priority within a
+		 * level-i busy period of pxTCB without any of its jobs missing its
+		 * deadline. Stolen time delays the jobs like blocking does, and the
+		 * response time only grows with it, so the largest amount that
+		 * passes the analysis is found by bisection. */
+		static TickType_t prvStaticSlack( const SchedTCB_t *pxTCB )
+		{
+			TickType_t xBlocking = prvBlocking( pxTCB );
+			TickType_t xLow = 0;
+			TickType_t xHigh = pxTCB->xRelativeDeadline;
+
+			while( xLow < xHigh )
+			{
+				TickType_t xMid = xLow + ( xHigh - xLow + 1 ) / 2;
+				if( portMAX_DELAY != prvResponseTime( pxTCB, xBlocking + xMid ) )
+				{
+					xLow = xMid;
+				}
+				else
+				{
+					xHigh = xMid - 1;
+				}
+			}
+			return xLow;
+		}
+	#endif /* schedBACKGROUND_STEALS_SLACK */
+
+	/* Creates a periodic task if the task set stays schedulable. */
+	BaseType_t xSchedulerPeriodicTaskAdmit( TaskFunction_t pvTaskCode, const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, void *pvParameters, UBaseType_t uxPriority,
+			TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick,
+			UBaseType_t uxMissPolicy, TickType_t *pxResponseTime )
+	{
+		BaseType_t xReturn = pdFAIL;
+		TickType_t xResponseTime = portMAX_DELAY;
+
+		#if( schedUSE_TASK_TABLE == 1 )
+			xTaskTableInUse = pdFALSE;
+		#endif /* schedUSE_TASK_TABLE */
+
+		if( xMaxExecTimeTick <= xDeadlineTick && xPeriodTick > 0 )
+		{
+			if( pdTRUE == xSchedulerStarted )
+			{
+				vTaskSuspendAll();
+			}
+			SchedTCB_t *pxNewTCB = prvPeriodicTaskInit( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, xPhaseTick,
+					xPeriodTick, xMaxExecTimeTick, xDeadlineTick, uxMissPolicy );
+			if( pxNewTCB != NULL )
+			{
+				prvSetFixedPriorities( prvAddTCBToArray( pxNewTCB ) );
+				xReturn = prvResponseTimeAnalysis();
+				if( pdFAIL == xReturn )
+				{
+					prvTaskSetChanged( prvDeleteTCBFromArray( pxNewTCB ) );
+				}
+				else if( pdTRUE == xSchedulerStarted )
+				{
+					xReturn = prvPeriodicTaskActivate( pxNewTCB );
+				}
+				if( pdPASS == xReturn )
+				{
+					xResponseTime = pxNewTCB->xResponseTime;
+				}
+			}
+			if( pdTRUE == xSchedulerStarted )
+			{
+				xTaskResumeAll();
+			}
+		}
+
+		if( pxResponseTime != NULL )
+		{
+			*pxResponseTime = xResponseTime;
+		}
+		return xReturn;
+	}
 
-	for( xIter = 0; xIter < xTaskCounter; xIter++ )
+	/* Returns the worst-case response time of a periodic task. */
+	TickType_t xSchedulerPeriodicTaskResponseTime( TaskHandle_t xTaskHandle )
 	{
-		xShortest = portMAX_DELAY;
+		SchedTCB_t *pxTCB = prvGetTCBFromHandle( xTaskHandle );
+		configASSERT( pxTCB != NULL );
+		return pxTCB->xResponseTime;
+	}
 
-		/* search for shortest period */
-		for( xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++ )
+	#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+		UBaseType_t uxSchedulerGetPreemptionThreshold( TaskHandle_t xTaskHandle )
+		{
+			SchedTCB_t *pxTCB = prvGetTCBFromHandle( xTaskHandle );
+			configASSERT( pxTCB != NULL );
+			return pxTCB->uxThreshold;
+		}
+
+		/* pxActiveTCBs is in priority order, so every task that can preempt
+		 * pxActiveTCBs[ i ] comes before it and its deepest chain is known.
+		 * Tasks at the threshold count, they share time slices. */
+		uint32_t ulSchedulerGetSharedStackDepth( void )
 		{
-			/* your implementation goes here */
-			#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS )
-				if ((xTCBArray[xIndex].xInUse == pdTRUE) && (xTCBArray[xIndex].xPriorityIsSet == pdFALSE) && (xTCBArray[xIndex].xPeriod < xShortest)){
-					xShortest = xTCBArray[ xIndex ].xPeriod;
-					pxShortestTaskPointer = &xTCBArray[xIndex];
+			uint32_t ulChain[ schedMAX_NUMBER_OF_PERIODIC_TASKS ];
+			uint32_t ulDeepest = 0;
+			BaseType_t xIndex, xOther;
+
+			vTaskSuspendAll();
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				const SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+				uint32_t ulPreempting = 0;
+				for( xOther = 0; xOther < xIndex; xOther++ )
+				{
+					if( pxActiveTCBs[ xOther ]->uxPriority >= pxTCB->uxThreshold && ulChain[ xOther ] > ulPreempting )
+					{
+						ulPreempting = ulChain[ xOther ];
+					}
 				}
-			#elif( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
-			    if ((xTCBArray[xIndex].xInUse == pdTRUE) && (xTCBArray[xIndex].xPriorityIsSet == pdFALSE) && (xTCBArray[xIndex].xRelativeDeadline < xShortest)){
-                    xShortest = xTCBArray[ xIndex ].xRelativeDeadline;
-					pxShortestTaskPointer = &xTCBArray[xIndex];
+				ulChain[ xIndex ] = pxTCB->usStackDepth + ulPreempting;
+				if( ulChain[ xIndex ] > ulDeepest )
+				{
+					ulDeepest = ulChain[ xIndex ];
 				}
-			#endif /* schedSCHEDULING_POLICY */
+			}
+			xTaskResumeAll();
+			return ulDeepest;
+		}
+	#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+
+#if( schedUSE_TASK_TABLE == 1 )
+	/* Creates the tasks of a task table with the priorities and response
+	 * times computed by the compiler. The rows are in priority order, so
+	 * every task is added at the end of pxActiveTCBs. */
+	void vSchedulerTaskTableCreateEntries( const SchedTaskTableEntry_t *pxEntries, UBaseType_t uxCount )
+	{
+		UBaseType_t uxIndex;
+
+		configASSERT( pdFALSE == xSchedulerStarted );
+		/* The table was computed for the Polling Server and nothing else. */
+		xTaskTableInUse = ( schedTASK_TABLE_SERVER_ROWS == xTaskCounter ) ? pdTRUE : pdFALSE;
+
+		for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+		{
+			const SchedTaskTableEntry_t *pxEntry = &pxEntries[ uxIndex ];
+			const SchedTaskSpec_t *pxSpec = &pxEntry->xSpec;
+			SchedTCB_t *pxTCB = NULL;
+
+			if( NULL == pxSpec->pvTaskCode )
+			{
+				#if( schedUSE_POLLING_SERVER == 1 )
+					/* The table knows server 0 only. */
+					pxTCB = xServerArray[ 0 ].pxTCB;
+				#endif /* schedUSE_POLLING_SERVER */
+			}
+			else
+			{
+				pxTCB = prvPeriodicTaskInit( pxSpec->pvTaskCode, pxSpec->pcName, pxSpec->usStackDepth, pxSpec->pvParameters, pxEntry->uxPriority,
+						pxSpec->pxCreatedTask, pxSpec->xPhaseTick, pxSpec->xPeriodTick, pxSpec->xMaxExecTimeTick, pxSpec->xDeadlineTick,
+						pxSpec->uxMissPolicy );
+				configASSERT( pxTCB != NULL );
+				prvAddTCBToArray( pxTCB );
+			}
+			configASSERT( pxTCB != NULL );
+			pxTCB->uxPriority = pxEntry->uxPriority;
+			pxTCB->xResponseTime = pxEntry->xResponseTime;
 		}
-		
-		/* set highest priority to task with xShortest period (the highest priority is configMAX_PRIORITIES-1) */		
-		
-		/* your implementation goes here */
-	pxShortestTaskPointer->uxPriority = xHighestPriority;
-	if(xHighestPriority > 0){
-		xHighestPriority--;
-	}else{
-		xHighestPriority = 0;
 	}
-	
-	pxShortestTaskPointer->xPriorityIsSet = pdTRUE;
+#endif /* schedUSE_TASK_TABLE */
+#elif( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+	/* Reorders priorities of all periodic tasks (including polling server) by
+	 * the absolute deadline of their pending job. Called before the tasks are
+	 * created and afterwards by the scheduler task. */
+	static void prvUpdatePrioritiesEDF( void )
+	{
+		BaseType_t xIter, xIndex;
+		SchedTCB_t *pxEarliestTaskPointer, *pxTCB;
+		BaseType_t xHighestPriority = schedSCHEDULER_PRIORITY;
+
+		for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+		{
+			pxActiveTCBs[ xIndex ]->xPriorityIsSet = pdFALSE;
+		}
+
+		for( xIter = 0; xIter < xTaskCounter; xIter++ )
+		{
+			pxEarliestTaskPointer = NULL;
+
+			/* search for earliest absolute deadline */
+			for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+			{
+				pxTCB = pxActiveTCBs[ xIndex ];
+				if( pxTCB->xPriorityIsSet == pdFALSE )
+				{
+					if( pxEarliestTaskPointer == NULL || ( SchedTickDiff_t ) ( pxTCB->xAbsoluteDeadline - pxEarliestTaskPointer->xAbsoluteDeadline ) < 0 )
+					{
+						pxEarliestTaskPointer = pxTCB;
+					}
+				}
+			}
+
+			if( pxEarliestTaskPointer == NULL )
+			{
+				break;
+			}
+
+			if( pxEarliestTaskPointer->uxPriority != ( UBaseType_t ) xHighestPriority )
+			{
+				pxEarliestTaskPointer->uxPriority = xHighestPriority;
+				/* Tasks are not created yet when called from vSchedulerStart. */
+				if( *pxEarliestTaskPointer->pxTaskHandle != NULL )
+				{
+					vTaskPrioritySet( *pxEarliestTaskPointer->pxTaskHandle, xHighestPriority );
+				}
+				#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+					/* The worker runs jobs at the server's priority. */
+					if( pdTRUE == pxEarliestTaskPointer->xIsPollingServer && pxEarliestTaskPointer->pxServerControl->xAperiodicWorkerHandle != NULL )
+					{
+						vTaskPrioritySet( pxEarliestTaskPointer->pxServerControl->xAperiodicWorkerHandle, xHighestPriority );
+					}
+				#endif /* schedUSE_APERIODIC_WORKER_TASK */
+			}
+			if( xHighestPriority > schedLOWEST_TASK_PRIORITY )
+			{
+				xHighestPriority--;
+			}
+
+			pxEarliestTaskPointer->xPriorityIsSet = pdTRUE;
+		}
 	}
-}
 #endif /* schedSCHEDULING_POLICY */
 
 
@@ -418,15 +2418,26 @@ static void prvSetFixedPriorities( void )
 	/* Recreates a deleted task that still has its information left in the task array (or list). */
 	static void prvPeriodicTaskRecreate( SchedTCB_t *pxTCB )
 	{
-		BaseType_t xReturnValue = xTaskCreate(prvPeriodicTaskCode,pxTCB->pcName,pxTCB->uxStackDepth,pxTCB->pvParameters,pxTCB->uxPriority,pxTCB->pxTaskHandle);
+		/* With static allocation this reuses the TCB and stack of the deleted
+		 * task and cannot fail. */
+		BaseType_t xReturnValue = prvCreateTask( pxTCB );
 				                      		
 		if( pdPASS == xReturnValue )
 		{
 			#if( schedUSE_TCB_ARRAY == 1 )
 				pxTCB->xInUse = pdTRUE;
 			#endif /* schedUSE_TCB_ARRAY */
+			#if( schedUSE_RESOURCES == 1 )
+				/* The critical section of the aborted job ends here. */
+				prvResourceReleaseAll( pxTCB );
+			#endif /* schedUSE_RESOURCES */
+			#if( schedUSE_MODES == 1 )
+				/* The aborted job will not complete. */
+				prvModeJobEnd( pxTCB );
+			#endif /* schedUSE_MODES */
     		#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
 				pxTCB->xExecutedOnce = pdFALSE;
+				pxTCB->xDeadlineMissed = pdFALSE;
 			#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 			#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
         		pxTCB->xSuspended = pdFALSE;
@@ -440,25 +2451,72 @@ static void prvSetFixedPriorities( void )
 		}
 	}
 
-	/* Called when a deadline of a periodic task is missed.
-	 * Deletes the periodic task that has missed it's deadline and recreate it.
-	 * The periodic task is released during next period. */
+	/* Returns the first release of the original schedule of pxTCB after
+	 * xTickCount, or at xTickCount if xInclusive is pdTRUE. */
+	static TickType_t prvNextReleaseTime( SchedTCB_t *pxTCB, TickType_t xTickCount, BaseType_t xInclusive )
+	{
+		TickType_t xElapsed = xTickCount - pxTCB->xLastWakeTime;
+		TickType_t xPeriods = xElapsed / pxTCB->xPeriod + 1;
+
+		if( pdTRUE == xInclusive && 0 == xElapsed % pxTCB->xPeriod )
+		{
+			xPeriods--;
+		}
+		return pxTCB->xLastWakeTime + xPeriods * pxTCB->xPeriod;
+	}
+
+	/* Called when a deadline of a periodic task is missed. With
+	 * schedMISS_POLICY_ABORT_JOB the task is deleted and created again on its
+	 * own memory, otherwise the job is left running and the releases are
+	 * adjusted by prvLateJobCompleted once it completes. */
 	static void prvDeadlineMissedHook( SchedTCB_t *pxTCB, TickType_t xTickCount )
 	{
-		Serial.print("Deadline missed - ");
-		Serial.print(pxTCB->pcName);
-		Serial.print(" - ");
-		Serial.println(xTaskGetTickCount());
-		Serial.flush();
+		prvTraceEvent( schedTRACE_EVENT_MISS, pxTCB, xTickCount );
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			pxTCB->xStatsCollector.xStats.ulDeadlineMissCount++;
+		#endif /* schedUSE_TASK_STATISTICS */
+		if( schedMISS_POLICY_ABORT_JOB != pxTCB->uxMissPolicy )
+		{
+			pxTCB->xDeadlineMissed = pdTRUE;
+			return;
+		}
+
 		/* Delete the pxTask and recreate it. */
+		#if( schedUSE_STACK_PROFILING == 1 )
+			prvStackSample( *pxTCB->pxTaskHandle, &pxTCB->usStackHighWaterMark );
+		#endif /* schedUSE_STACK_PROFILING */
 		vTaskDelete( *pxTCB->pxTaskHandle );
 		pxTCB->xWorkIsDone = pdFALSE;
-		pxTCB->xExecTime = 0;
-		prvPeriodicTaskRecreate( pxTCB );	
-		
-		pxTCB->xReleaseTime = pxTCB->xLastWakeTime + pxTCB->xPeriod;
-		pxTCB->xLastWakeTime = xTickCount;
-		pxTCB->xAbsoluteDeadline = pxTCB->xRelativeDeadline + pxTCB->xReleaseTime;
+		prvResetExecTime( pxTCB );
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			pxTCB->xExecTimeCarry = 0;
+		#endif /* schedUSE_TASK_STATISTICS */
+		pxTCB->xLastWakeTime = prvNextReleaseTime( pxTCB, xTickCount, pdFALSE );
+		pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
+		prvPeriodicTaskRecreate( pxTCB );
+		/* Under EDF the moved deadline is picked up by the scheduler task
+		 * before it blocks again. */
+	}
+
+	/* Called by a periodic task when a job that missed its deadline has
+	 * completed. Moves xLastWakeTime one period before the next release. */
+	static void prvLateJobCompleted( SchedTCB_t *pxTCB, TickType_t xTickCount )
+	{
+		TickType_t xNextRelease = pxTCB->xLastWakeTime + pxTCB->xPeriod;
+
+		if( schedMISS_POLICY_SKIP_NEXT == pxTCB->uxMissPolicy )
+		{
+			xNextRelease = prvNextReleaseTime( pxTCB, xTickCount, pdTRUE );
+		}
+		else if( ( SchedTickDiff_t ) ( xNextRelease - xTickCount ) < 0 )
+		{
+			xNextRelease = xTickCount;
+		}
+		pxTCB->xLastWakeTime = xNextRelease - pxTCB->xPeriod;
+		pxTCB->xDeadlineMissed = pdFALSE;
+
+		/* The scheduler task ignored this task while the job was late. */
+		prvSchedulerRequestWake( xNextRelease + pxTCB->xRelativeDeadline + 1 );
 	}
 
 	/* Checks whether given task has missed deadline or not. */
@@ -466,9 +2524,9 @@ static void prvSetFixedPriorities( void )
 	{ 
 		/* check whether deadline is missed. */     		
 		/* your implementation goes here */
-		if((pxTCB->xWorkIsDone==pdFALSE)&&(pxTCB->xExecutedOnce==pdTRUE)){
+		if((pxTCB->xWorkIsDone==pdFALSE)&&(pxTCB->xExecutedOnce==pdTRUE)&&(pxTCB->xDeadlineMissed==pdFALSE)){
 			pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
-			if(pxTCB->xAbsoluteDeadline < xTickCount){
+			if( ( SchedTickDiff_t ) ( pxTCB->xAbsoluteDeadline - xTickCount ) < 0 ){
 				prvDeadlineMissedHook(pxTCB, xTickCount);
 			}
 		}
@@ -484,22 +2542,47 @@ static void prvSetFixedPriorities( void )
 	 * the scheduler task occur to block the periodic task. */
 	static void prvExecTimeExceedHook( TickType_t xTickCount, SchedTCB_t *pxCurrentTask )
 	{
-        Serial.print(pxCurrentTask->pcName);
-        Serial.print(" Exceeded - ");
-		Serial.println(xTaskGetTickCount());
-        Serial.flush();
+        prvTraceEvent( schedTRACE_EVENT_OVERRUN, pxCurrentTask, xTickCount );
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			pxCurrentTask->xStatsCollector.xStats.ulOverrunCount++;
+		#endif /* schedUSE_TASK_STATISTICS */
         pxCurrentTask->xMaxExecTimeExceeded = pdTRUE;
         /* Is not suspended yet, but will be suspended by the scheduler later. */
         pxCurrentTask->xSuspended = pdTRUE;
-        pxCurrentTask->xAbsoluteUnblockTime = pxCurrentTask->xLastWakeTime + pxCurrentTask->xPeriod;
-        pxCurrentTask->xExecTime = 0;
 
-		#if( schedUSE_POLLING_SERVER == 1)
+		#if( schedUSE_POLLING_SERVER == 1 && schedUSE_SPORADIC_SERVER == 1 )
+			if( pxCurrentTask->xIsPollingServer == pdTRUE )
+			{
+				/* Budget is exhausted: keep xExecTime as consumed budget and
+				 * block until the earliest replenishment. */
+				ServerControl_t *pxControl = pxCurrentTask->pxServerControl;
+				prvSporadicServerChunkEnd( pxCurrentTask, xTickCount );
+				pxCurrentTask->xAbsoluteUnblockTime = pxControl->xReplenishmentArray[ pxControl->uxReplenishmentFirst ].xTime;
+			}
+			else
+		#elif( schedUSE_POLLING_SERVER == 1 && schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
 			if( pxCurrentTask->xIsPollingServer == pdTRUE )
 			{
-				pxCurrentTask->xAbsoluteDeadline = pxCurrentTask->xAbsoluteUnblockTime + pxCurrentTask->xRelativeDeadline;
+				/* The job overran its WCET: block it until its deadline, then
+				 * continue with a recharged budget and a postponed deadline. */
+				pxCurrentTask->xAbsoluteUnblockTime = pxCurrentTask->xAbsoluteDeadline;
+				pxCurrentTask->xAbsoluteDeadline += prvTotalBandwidthServerBudgetTime( pxCurrentTask->xMaxExecTime );
+				pxCurrentTask->xLastJobDeadline = pxCurrentTask->xAbsoluteDeadline;
+				prvResetExecTime( pxCurrentTask );
+			}
+			else
+		#endif /* schedUSE_SPORADIC_SERVER || schedUSE_TOTAL_BANDWIDTH_SERVER */
+			{
+				pxCurrentTask->xAbsoluteUnblockTime = pxCurrentTask->xLastWakeTime + pxCurrentTask->xPeriod;
+				prvResetExecTime( pxCurrentTask );
+
+				#if( schedUSE_POLLING_SERVER == 1)
+					if( pxCurrentTask->xIsPollingServer == pdTRUE )
+					{
+						pxCurrentTask->xAbsoluteDeadline = pxCurrentTask->xAbsoluteUnblockTime + pxCurrentTask->xRelativeDeadline;
+					}
+				#endif /* schedUSE_POLLING_SERVER */
 			}
-		#endif /* schedUSE_POLLING_SERVER */
         
         BaseType_t xHigherPriorityTaskWoken;
         vTaskNotifyGiveFromISR( xSchedulerHandle, &xHigherPriorityTaskWoken );
@@ -538,28 +2621,37 @@ static void prvSetFixedPriorities( void )
 		
 
 		#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
-        if( pdTRUE == pxTCB->xMaxExecTimeExceeded )
+		#if( schedUSE_RESOURCES == 1 )
+			/* A critical section runs to its end, vSchedulerResourceGive
+			 * wakes this task again. */
+			if( pdTRUE == pxTCB->xMaxExecTimeExceeded && 0 == pxTCB->uxResourcesHeld )
+		#else
+			if( pdTRUE == pxTCB->xMaxExecTimeExceeded )
+		#endif /* schedUSE_RESOURCES */
         {
             pxTCB->xMaxExecTimeExceeded = pdFALSE;
-            Serial.print(pxTCB->pcName);
-            Serial.print(" suspended - ");
-            Serial.print(xTaskGetTickCount());
-            Serial.print("\n");
-            Serial.flush();
-            vTaskSuspend( *pxTCB->pxTaskHandle );
+            prvTraceEvent( schedTRACE_EVENT_SUSPEND, pxTCB, xTickCount );
+            vTaskSuspend( prvGetExecutionHandle( pxTCB ) );
         }
         if( pdTRUE == pxTCB->xSuspended )
         {
-            if( ( signed ) ( pxTCB->xAbsoluteUnblockTime - xTickCount ) <= 0 )
+            if( ( SchedTickDiff_t ) ( pxTCB->xAbsoluteUnblockTime - xTickCount ) <= 0 )
             {
                 pxTCB->xSuspended = pdFALSE;
+                #if( schedUSE_RESOURCES == 1 )
+                    /* The suspension was deferred past its end. */
+                    pxTCB->xMaxExecTimeExceeded = pdFALSE;
+                #endif /* schedUSE_RESOURCES */
                 pxTCB->xLastWakeTime = xTickCount;
-                Serial.print(pxTCB->pcName);
-                Serial.print(" resumed - ");
-                Serial.print(xTaskGetTickCount());
-            	Serial.print("\n");
-                Serial.flush();
-                vTaskResume( *pxTCB->pxTaskHandle );
+                prvTraceEvent( schedTRACE_EVENT_RESUME, pxTCB, xTickCount );
+                #if( schedUSE_POLLING_SERVER == 1 && schedUSE_SPORADIC_SERVER == 1 )
+                    if( pdTRUE == pxTCB->xIsPollingServer )
+                    {
+                        /* Resumed with replenished budget and a job in progress. */
+                        prvSporadicServerChunkStart( pxTCB, xTickCount );
+                    }
+                #endif /* schedUSE_SPORADIC_SERVER */
+                vTaskResume( prvGetExecutionHandle( pxTCB ) );
             }
         }
 		#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
@@ -567,184 +2659,998 @@ static void prvSetFixedPriorities( void )
 		return;
 	}
 
-	#if( schedUSE_APERIODIC_JOBS == 1 )
-	/* Returns ATC of first aperiodic job stored in ATC Array. Returns NULL if
-	 * the ATC Array is empty. */
-	static ATC_t *prvGetNextAperiodicTask( void )
-	{
-		/* If ATC Array is empty. */
-		if( uxAperiodicTaskCounter == 0 )
+	#if( schedUSE_APERIODIC_JOBS == 1 )
+	/* Returns pdTRUE if aperiodic job pxA is served before pxB: earlier release
+	 * time first, then higher job priority. */
+	static BaseType_t prvATCIsBefore( const ATC_t *pxA, const ATC_t *pxB )
+	{
+		if( pxA->xReleaseTime != pxB->xReleaseTime )
+		{
+			return ( ( SchedTickDiff_t ) ( pxA->xReleaseTime - pxB->xReleaseTime ) < 0 ) ? pdTRUE : pdFALSE;
+		}
+		return ( pxA->uxPriority > pxB->uxPriority ) ? pdTRUE : pdFALSE;
+	}
+
+	/* Swaps two entries of the ATC heap. */
+	static void prvATCSwap( ServerControl_t *pxControl, UBaseType_t uxA, UBaseType_t uxB )
+	{
+		ATC_t xTemp = pxControl->xATCArray[ uxA ];
+		pxControl->xATCArray[ uxA ] = pxControl->xATCArray[ uxB ];
+		pxControl->xATCArray[ uxB ] = xTemp;
+	}
+
+	/* Removes the root of the ATC heap and copies it to pxJob. Must be called
+	 * in a critical section with a non-empty heap. */
+	static void prvATCHeapPop( ServerControl_t *pxControl, ATC_t *pxJob )
+	{
+		UBaseType_t uxIndex = 0;
+
+		*pxJob = pxControl->xATCArray[ 0 ];
+		pxControl->uxAperiodicTaskCounter--;
+		pxControl->xATCArray[ 0 ] = pxControl->xATCArray[ pxControl->uxAperiodicTaskCounter ];
+
+		/* Sift the moved entry down. */
+		for( ; ; )
+		{
+			UBaseType_t uxChild = 2 * uxIndex + 1;
+			if( uxChild >= pxControl->uxAperiodicTaskCounter )
+			{
+				break;
+			}
+			if( uxChild + 1 < pxControl->uxAperiodicTaskCounter && pdTRUE == prvATCIsBefore( &pxControl->xATCArray[ uxChild + 1 ], &pxControl->xATCArray[ uxChild ] ) )
+			{
+				uxChild++;
+			}
+			if( pdFALSE == prvATCIsBefore( &pxControl->xATCArray[ uxChild ], &pxControl->xATCArray[ uxIndex ] ) )
+			{
+				break;
+			}
+			prvATCSwap( pxControl, uxIndex, uxChild );
+			uxIndex = uxChild;
+		}
+	}
+
+	/* Inserts a job into the ATC heap. Returns pdFAIL if the heap is full.
+	 * Must be called in a critical section. */
+	static BaseType_t prvATCHeapPush( ServerControl_t *pxControl, const ATC_t *pxJob )
+	{
+		if( schedMAX_NUMBER_OF_APERIODIC_JOBS == pxControl->uxAperiodicTaskCounter )
+		{
+			return pdFAIL;
+		}
+
+		UBaseType_t uxIndex = pxControl->uxAperiodicTaskCounter;
+		pxControl->xATCArray[ uxIndex ] = *pxJob;
+		pxControl->uxAperiodicTaskCounter++;
+
+		/* Sift the new entry up. */
+		while( uxIndex > 0 )
+		{
+			UBaseType_t uxParent = ( uxIndex - 1 ) / 2;
+			if( pdFALSE == prvATCIsBefore( &pxControl->xATCArray[ uxIndex ], &pxControl->xATCArray[ uxParent ] ) )
+			{
+				break;
+			}
+			prvATCSwap( pxControl, uxIndex, uxParent );
+			uxIndex = uxParent;
+		}
+		return pdPASS;
+	}
+
+	/* Moves jobs submitted from interrupt handlers into the ATC heap. Jobs
+	 * stay in the ring while the heap is full. The tail is advanced in the
+	 * critical section, so the server and the background service may both
+	 * drain the ring. */
+	static void prvATCDrainISRQueue( ServerControl_t *pxControl )
+	{
+		while( pxControl->ucATCISRQueueTail != pxControl->ucATCISRQueueHead )
+		{
+			schedCOMPILER_BARRIER();
+			taskENTER_CRITICAL();
+			BaseType_t xReturnValue = pdFAIL;
+			if( pxControl->ucATCISRQueueTail != pxControl->ucATCISRQueueHead )
+			{
+				xReturnValue = prvATCHeapPush( pxControl, &pxControl->xATCISRQueue[ pxControl->ucATCISRQueueTail & ( schedAPERIODIC_ISR_QUEUE_LENGTH - 1 ) ] );
+				if( pdPASS == xReturnValue )
+				{
+					pxControl->ucATCISRQueueTail = pxControl->ucATCISRQueueTail + 1;
+				}
+			}
+			taskEXIT_CRITICAL();
+			if( pdFAIL == xReturnValue )
+			{
+				break;
+			}
+		}
+	}
+
+	/* Returns ATC of the next released aperiodic job of the given server,
+	 * removed from its ATC heap. Returns NULL if the heap is empty or no
+	 * queued job is released yet. The returned ATC stays valid until the next
+	 * call. */
+	static ATC_t *prvGetNextAperiodicTask( ServerControl_t *pxControl )
+	{
+		#if( schedSERVER_IS_EVENT_DRIVEN )
+			/* Event-driven servers serve jobs released during their instance too. */
+			TickType_t xServeUntil = xTaskGetTickCount();
+		#else
+			TickType_t xServeUntil = pxControl->pxTCB->xStartTime;
+		#endif /* schedSERVER_IS_EVENT_DRIVEN */
+		ATC_t *pxNextAT = NULL;
+
+		prvATCDrainISRQueue( pxControl );
+
+		taskENTER_CRITICAL();
+		/* The root has the earliest release time, so if it is not released,
+		 * no other job is. */
+		if( pxControl->uxAperiodicTaskCounter > 0 && ( SchedTickDiff_t ) ( pxControl->xATCArray[ 0 ].xReleaseTime - xServeUntil ) <= 0 )
+		{
+			prvATCHeapPop( pxControl, &pxControl->xCurrentAperiodicJob );
+			pxNextAT = &pxControl->xCurrentAperiodicJob;
+		}
+		taskEXIT_CRITICAL();
+
+		return pxNextAT;
+	}
+
+	/* Creates an aperiodic job. */
+	void vSchedulerAperiodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters, TickType_t xMaxExecTimeTick, TickType_t xPhaseTick )
+	{
+		vSchedulerAperiodicTaskCreatePriority( pvTaskCode, pcName, pvParameters, xMaxExecTimeTick, xPhaseTick, 0 );
+	}
+
+	/* Creates an aperiodic job with a priority among jobs released at the same time. */
+	void vSchedulerAperiodicTaskCreatePriority( TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters, TickType_t xMaxExecTimeTick, TickType_t xPhaseTick, UBaseType_t uxPriority )
+	{
+		vSchedulerAperiodicTaskCreateOnServer( 0, pvTaskCode, pcName, pvParameters, xMaxExecTimeTick, xPhaseTick, uxPriority );
+	}
+
+	/* Creates an aperiodic job served by the given server. */
+	void vSchedulerAperiodicTaskCreateOnServer( UBaseType_t uxServer, TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters,
+			TickType_t xMaxExecTimeTick, TickType_t xPhaseTick, UBaseType_t uxPriority )
+	{
+		configASSERT( uxServer < uxServerCounter );
+		ServerControl_t *pxControl = &xServerArray[ uxServer ];
+		ATC_t xNewATC = { .pvTaskCode = pvTaskCode, .pcName = pcName, .pvParameters = pvParameters, .xReleaseTime = xPhaseTick, .xMaxExecTime = xMaxExecTimeTick, .xExecTime = 0, .uxPriority = uxPriority, };
+
+		taskENTER_CRITICAL();
+		BaseType_t xReturnValue = prvATCHeapPush( pxControl, &xNewATC );
+		taskEXIT_CRITICAL();
+		if( pdFAIL == xReturnValue )
+		{
+			/* The ATC heap is full. */
+			return;
+		}
+
+		#if( schedSERVER_IS_EVENT_DRIVEN )
+			/* Wake the server in case it is waiting for new jobs. */
+			if( pxControl->xHandle != NULL )
+			{
+				xTaskNotifyGive( pxControl->xHandle );
+			}
+		#endif /* schedSERVER_IS_EVENT_DRIVEN */
+		#if( schedUSE_BACKGROUND_SERVICE == 1 )
+			if( xBackgroundHandle != NULL )
+			{
+				xTaskNotifyGive( xBackgroundHandle );
+			}
+		#endif /* schedUSE_BACKGROUND_SERVICE */
+	}
+
+	/* Submits an aperiodic job from an interrupt handler. */
+	BaseType_t xSchedulerAperiodicJobSubmitFromISR( TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters, TickType_t xMaxExecTimeTick,
+			BaseType_t *pxHigherPriorityTaskWoken )
+	{
+		return xSchedulerAperiodicJobSubmitToServerFromISR( 0, pvTaskCode, pcName, pvParameters, xMaxExecTimeTick, pxHigherPriorityTaskWoken );
+	}
+
+	/* Submits an aperiodic job to the given server from an interrupt handler. */
+	BaseType_t xSchedulerAperiodicJobSubmitToServerFromISR( UBaseType_t uxServer, TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters,
+			TickType_t xMaxExecTimeTick, BaseType_t *pxHigherPriorityTaskWoken )
+	{
+		if( uxServer >= uxServerCounter )
+		{
+			return pdFAIL;
+		}
+
+		ServerControl_t *pxControl = &xServerArray[ uxServer ];
+		uint8_t ucHead = pxControl->ucATCISRQueueHead;
+
+		if( ( uint8_t ) ( ucHead - pxControl->ucATCISRQueueTail ) >= schedAPERIODIC_ISR_QUEUE_LENGTH )
+		{
+			/* The ring is full. */
+			return pdFAIL;
+		}
+
+		pxControl->xATCISRQueue[ ucHead & ( schedAPERIODIC_ISR_QUEUE_LENGTH - 1 ) ] = ( ATC_t ) { .pvTaskCode = pvTaskCode, .pcName = pcName, .pvParameters = pvParameters,
+				.xReleaseTime = xTaskGetTickCountFromISR(), .xMaxExecTime = xMaxExecTimeTick, .xExecTime = 0, .uxPriority = 0, };
+		/* Publish the slot only after it is written. */
+		schedCOMPILER_BARRIER();
+		pxControl->ucATCISRQueueHead = ucHead + 1;
+
+		#if( schedSERVER_IS_EVENT_DRIVEN )
+			/* Wake the server in case it is waiting for new jobs. */
+			if( pxControl->xHandle != NULL )
+			{
+				vTaskNotifyGiveFromISR( pxControl->xHandle, pxHigherPriorityTaskWoken );
+			}
+		#endif /* schedSERVER_IS_EVENT_DRIVEN */
+		#if( schedUSE_BACKGROUND_SERVICE == 1 )
+			if( xBackgroundHandle != NULL )
+			{
+				vTaskNotifyGiveFromISR( xBackgroundHandle, pxHigherPriorityTaskWoken );
+			}
+		#endif /* schedUSE_BACKGROUND_SERVICE */
+		( void ) pxHigherPriorityTaskWoken;
+
+		return pdPASS;
+	}
+#endif /* schedUSE_APERIODIC_JOBS */
+
+#if( schedUSE_POLLING_SERVER == 1 )
+	/* Function code for the Polling Server. */
+	static void prvPollingServerFunction( void )
+	{
+		SchedTCB_t *pxServer = prvGetTCBFromHandle( NULL );
+		#if( schedUSE_APERIODIC_JOBS == 1 )
+			ServerControl_t *pxControl = pxServer->pxServerControl;
+		#endif /* schedUSE_APERIODIC_JOBS */
+
+		for( ; ; )
+		{
+			#if( schedUSE_APERIODIC_JOBS == 1 )
+				#if( schedUSE_MODES == 1 )
+					/* Marked before the job leaves the queue, so a mode change
+					 * never deletes the server with a job in hand. */
+					prvModeJobBegin( pxServer );
+				#endif /* schedUSE_MODES */
+				pxControl->pxCurrentAperiodicTask = prvGetNextAperiodicTask( pxControl );
+				#if( schedUSE_MODES == 1 )
+					if( pxControl->pxCurrentAperiodicTask == NULL )
+					{
+						prvModeJobEnd( pxServer );
+					}
+				#endif /* schedUSE_MODES */
+				#if( schedUSE_SPORADIC_SERVER == 1 )
+					/* A Sporadic Server never ends its instance; it idles until
+					 * the next job and charges budget in chunks. */
+					if( pxControl->pxCurrentAperiodicTask == NULL )
+					{
+						taskENTER_CRITICAL();
+						prvSporadicServerChunkEnd( pxServer, xTaskGetTickCount() );
+						taskEXIT_CRITICAL();
+						prvServerWaitForJob( pxServer );
+						continue;
+					}
+					prvSporadicServerChunkStart( pxServer, xTaskGetTickCount() );
+				#elif( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+					/* A Total Bandwidth Server never ends its instance; each job
+					 * runs under its own deadline. */
+					if( pxControl->pxCurrentAperiodicTask == NULL )
+					{
+						prvServerWaitForJob( pxServer );
+						continue;
+					}
+					prvTotalBandwidthServerDispatch( pxServer, pxControl->pxCurrentAperiodicTask );
+				#endif /* schedUSE_SPORADIC_SERVER || schedUSE_TOTAL_BANDWIDTH_SERVER */
+				if( pxControl->pxCurrentAperiodicTask == NULL )
+				{
+					#if( schedUSE_DEFERRABLE_SERVER == 1 )
+						/* Keep the budget and wait for the next job. */
+						if( pdTRUE == prvDeferrableServerWait( pxServer ) )
+						{
+							continue;
+						}
+					#endif /* schedUSE_DEFERRABLE_SERVER */
+					/* No ready aperiodic task in the queue. */
+					return;
+				}
+				else
+				{
+					/* Run aperiodic task */
+					prvRunAperiodicJob( pxServer, pxControl->pxCurrentAperiodicTask );
+					#if( schedUSE_MODES == 1 )
+						prvModeJobEnd( pxServer );
+					#endif /* schedUSE_MODES */
+				}
+			#endif /* schedUSE_APERIODIC_JOBS */
+		}
+	}
+
+	/* Runs the given aperiodic job to completion on behalf of the calling server. */
+	static void prvRunAperiodicJob( SchedTCB_t *pxServer, ATC_t *pxJob )
+	{
+		TickType_t xStartTime = xTaskGetTickCount();
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			/* The job consumes the budget of the server. */
+			TickType_t xStartExecTime = pxServer->xExecTimeCarry + prvGetExecTime( pxServer );
+		#endif /* schedUSE_TASK_STATISTICS */
+
+		/* Aperiodic jobs have no entry in xTCBArray, so they are only
+		 * reported to the hook and not recorded in the trace buffer. */
+		schedTRACE_EVENT_HOOK( schedTRACE_EVENT_START, pxJob->pcName, xStartTime );
+		#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+			ServerControl_t *pxControl = pxServer->pxServerControl;
+			pxControl->xAperiodicJobDone = pdFALSE;
+			vTaskPrioritySet( pxControl->xAperiodicWorkerHandle, uxTaskPriorityGet( NULL ) );
+			xTaskNotifyGive( pxControl->xAperiodicWorkerHandle );
+			/* Notifications for new jobs may wake the server early. While the
+			 * worker is suspended for lack of budget, the server keeps waiting,
+			 * so the job resumes in a later server instance. */
+			while( pdFALSE == pxControl->xAperiodicJobDone )
+			{
+				ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+			}
+		#else
+			pxJob->pvTaskCode( pxJob->pvParameters );
+		#endif /* schedUSE_APERIODIC_WORKER_TASK */
+		TickType_t xEndTime = xTaskGetTickCount();
+		schedTRACE_EVENT_HOOK( schedTRACE_EVENT_END, pxJob->pcName, xEndTime );
+
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			prvStatsRecordJob( &xAperiodicStats, pxServer->xExecTimeCarry + prvGetExecTime( pxServer ) - xStartExecTime,
+					xEndTime - pxJob->xReleaseTime, xStartTime - pxJob->xReleaseTime );
+			#if( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+				if( ( SchedTickDiff_t ) ( xEndTime - pxJob->xAbsoluteDeadline ) > 0 )
+				{
+					xAperiodicStats.xStats.ulDeadlineMissCount++;
+				}
+			#endif /* schedUSE_TOTAL_BANDWIDTH_SERVER */
+		#endif /* schedUSE_TASK_STATISTICS */
+	}
+
+	#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+		/* Function code for the aperiodic worker of the server whose
+		 * ServerControl_t is passed. Runs one job per notification from the
+		 * server. */
+		static void prvAperiodicWorkerFunction( void *pvParameters )
+		{
+			ServerControl_t *pxControl = ( ServerControl_t * ) pvParameters;
+
+			for( ; ; )
+			{
+				ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+				pxControl->pxCurrentAperiodicTask->pvTaskCode( pxControl->pxCurrentAperiodicTask->pvParameters );
+				pxControl->xAperiodicJobDone = pdTRUE;
+				xTaskNotifyGive( pxControl->xHandle );
+			}
+		}
+
+		/* Creates the aperiodic worker of a server at the server's priority.
+		 * Must be called after the server task exists. */
+		static void prvCreateAperiodicWorker( ServerControl_t *pxControl )
+		{
+			SchedTCB_t *pxServer = pxControl->pxTCB;
+			#if( schedUSE_STATIC_ALLOCATION == 1 )
+				pxControl->xAperiodicWorkerHandle = xTaskCreateStatic( prvAperiodicWorkerFunction, "AW", schedAPERIODIC_WORKER_STACK_SIZE, pxControl,
+						pxServer->uxPriority, pxControl->xWorkerStack, &pxControl->xWorkerTaskBuffer );
+				BaseType_t xReturnValue = ( pxControl->xAperiodicWorkerHandle != NULL ) ? pdPASS : pdFAIL;
+			#else
+				BaseType_t xReturnValue = xTaskCreate( prvAperiodicWorkerFunction, "AW", schedAPERIODIC_WORKER_STACK_SIZE, pxControl, pxServer->uxPriority,
+						&pxControl->xAperiodicWorkerHandle );
+			#endif /* schedUSE_STATIC_ALLOCATION */
+			if( pdPASS == xReturnValue )
+			{
+				vTaskSetThreadLocalStoragePointer( pxControl->xAperiodicWorkerHandle, schedTHREAD_LOCAL_STORAGE_POINTER_INDEX, pxServer );
+			}
+			else
+			{
+				Serial.println("Worker creation failed");
+				Serial.flush();
+			}
+		}
+
+		/* Called by the scheduler task when the current job of a server has
+		 * exceeded its WCET. Restarts the worker without the job and hands
+		 * control back to the server. */
+		static void prvAbortAperiodicJob( ServerControl_t *pxControl )
+		{
+			prvTraceEvent( schedTRACE_EVENT_ABORT, pxControl->pxTCB, xTaskGetTickCount() );
+			#if( schedUSE_TASK_STATISTICS == 1 )
+				xAperiodicStats.xStats.ulOverrunCount++;
+			#endif /* schedUSE_TASK_STATISTICS */
+			#if( schedUSE_STACK_PROFILING == 1 )
+				prvStackSample( pxControl->xAperiodicWorkerHandle, &pxControl->xWorkerStackProfile.usHighWaterMark );
+			#endif /* schedUSE_STACK_PROFILING */
+			vTaskDelete( pxControl->xAperiodicWorkerHandle );
+			prvCreateAperiodicWorker( pxControl );
+			pxControl->xAperiodicJobOverrun = pdFALSE;
+			pxControl->xAperiodicJobDone = pdTRUE;
+			xTaskNotifyGive( pxControl->xHandle );
+		}
+	#endif /* schedUSE_APERIODIC_WORKER_TASK */
+
+	#if( schedUSE_DEFERRABLE_SERVER == 1 )
+		/* Blocks the Deferrable Server until a new job is submitted, the first
+		 * queued job is released or the current period ends. Budget is only
+		 * charged by the tick hook while the server runs, so waiting preserves it.
+		 * Returns pdFALSE once the period is over. */
+		static BaseType_t prvDeferrableServerWait( SchedTCB_t *pxServer )
+		{
+			ServerControl_t *pxControl = pxServer->pxServerControl;
+			TickType_t xTickCount = xTaskGetTickCount();
+			TickType_t xPeriodEnd = pxServer->xLastWakeTime + pxServer->xPeriod;
+
+			if( ( SchedTickDiff_t ) ( xPeriodEnd - xTickCount ) <= 0 )
+			{
+				return pdFALSE;
+			}
+
+			TickType_t xTimeout = xPeriodEnd - xTickCount;
+			taskENTER_CRITICAL();
+			if( pxControl->uxAperiodicTaskCounter > 0 && ( SchedTickDiff_t ) ( pxControl->xATCArray[ 0 ].xReleaseTime - xTickCount ) < ( SchedTickDiff_t ) xTimeout )
+			{
+				xTimeout = pxControl->xATCArray[ 0 ].xReleaseTime - xTickCount;
+			}
+			taskEXIT_CRITICAL();
+
+			/* The first job may have been released in the meantime. */
+			if( ( SchedTickDiff_t ) xTimeout > 0 )
+			{
+				ulTaskNotifyTake( pdTRUE, xTimeout );
+			}
+			return pdTRUE;
+		}
+	#endif /* schedUSE_DEFERRABLE_SERVER */
+
+	#if( schedUSE_SPORADIC_SERVER == 1 )
+		/* Marks the server active. The budget consumed from now on is given
+		 * back one server period later. No-op if a chunk is already open. */
+		static void prvSporadicServerChunkStart( SchedTCB_t *pxServer, TickType_t xTickCount )
 		{
-			return NULL;
+			taskENTER_CRITICAL();
+			if( pdFALSE == pxServer->xChunkActive )
+			{
+				pxServer->xChunkActive = pdTRUE;
+				pxServer->xChunkStartTime = xTickCount;
+				pxServer->xChunkStartExecTime = pxServer->xExecTime;
+			}
+			taskEXIT_CRITICAL();
 		}
 
-        TaskHandle_t xCurrentTaskHandle = xTaskGetCurrentTaskHandle();  
-        configASSERT(xCurrentTaskHandle != NULL);
-		BaseType_t xIndex = prvGetTCBIndexFromHandle(xCurrentTaskHandle);
-        configASSERT(xIndex != -1);
-	    SchedTCB_t *pxThisTask = &xTCBArray[xIndex];
-        
-        if( xATCArray[ xATCArrayFirst ].xReleaseTime <= pxThisTask->xStartTime )
+		/* Closes the current chunk and schedules its replenishment. A chunk
+		 * counts as a job of the server in its statistics. Called with
+		 * interrupts disabled, either from the tick hook or in a critical section. */
+		static void prvSporadicServerChunkEnd( SchedTCB_t *pxServer, TickType_t xTickCount )
 		{
-			ATC_t *pxNextAT = &xATCArray[ xATCArrayFirst ];
+			ServerControl_t *pxControl = pxServer->pxServerControl;
 
-			/* Move ATC Array head to next element in the queue. */
-			xATCArrayFirst++;
-			if( schedMAX_NUMBER_OF_APERIODIC_JOBS == xATCArrayFirst )
+			if( pdFALSE == pxServer->xChunkActive )
 			{
-				xATCArrayFirst = 0;             //restting ATC Array head to 0 when end of array is reached
+				return;
 			}
+			pxServer->xChunkActive = pdFALSE;
 
-			return pxNextAT;
-		}
-		else
-		{
-			return NULL;
+			TickType_t xAmount = pxServer->xExecTime - pxServer->xChunkStartExecTime;
+			if( 0 == xAmount )
+			{
+				return;
+			}
+			#if( schedUSE_TASK_STATISTICS == 1 )
+				prvStatsRecordJob( &pxServer->xStatsCollector, xAmount, xTickCount - pxServer->xChunkStartTime, 0 );
+			#endif /* schedUSE_TASK_STATISTICS */
+
+			TickType_t xTime = pxServer->xChunkStartTime + pxServer->xPeriod;
+			if( schedSPORADIC_SERVER_MAX_REPLENISHMENTS == pxControl->uxReplenishmentCounter )
+			{
+				/* Merging into the latest entry only delays budget, which is safe
+				 * for the periodic tasks. */
+				UBaseType_t uxLast = ( pxControl->uxReplenishmentFirst + pxControl->uxReplenishmentCounter - 1 ) % schedSPORADIC_SERVER_MAX_REPLENISHMENTS;
+				pxControl->xReplenishmentArray[ uxLast ].xTime = xTime;
+				pxControl->xReplenishmentArray[ uxLast ].xAmount += xAmount;
+			}
+			else
+			{
+				UBaseType_t uxLast = ( pxControl->uxReplenishmentFirst + pxControl->uxReplenishmentCounter ) % schedSPORADIC_SERVER_MAX_REPLENISHMENTS;
+				pxControl->xReplenishmentArray[ uxLast ] = ( SSReplenishment_t ) { .xTime = xTime, .xAmount = xAmount };
+				pxControl->uxReplenishmentCounter++;
+			}
 		}
-	}
 
-	/* Find index for an empty entry in xATCArray. Returns -1 if there is
-	 * no empty entry. */
-	static BaseType_t prvGetEmptyIndexATC( void )
-	{
-		/* If the ATC Array is full. */
-		if( schedMAX_NUMBER_OF_APERIODIC_JOBS == uxAperiodicTaskCounter )
+		/* Called every tick. Gives back budget whose replenishment time has come. */
+		static void prvSporadicServerReplenish( SchedTCB_t *pxServer, TickType_t xTickCount )
 		{
-			return -1;
+			ServerControl_t *pxControl = pxServer->pxServerControl;
+
+			while( pxControl->uxReplenishmentCounter > 0 && ( SchedTickDiff_t ) ( pxControl->xReplenishmentArray[ pxControl->uxReplenishmentFirst ].xTime - xTickCount ) <= 0 )
+			{
+				TickType_t xAmount = pxControl->xReplenishmentArray[ pxControl->uxReplenishmentFirst ].xAmount;
+				pxServer->xExecTime -= xAmount;
+				#if( schedUSE_TASK_STATISTICS == 1 )
+					pxServer->xExecTimeCarry += xAmount;
+				#endif /* schedUSE_TASK_STATISTICS */
+				if( pdTRUE == pxServer->xChunkActive )
+				{
+					/* Keep the consumption of the open chunk unchanged. */
+					pxServer->xChunkStartExecTime -= xAmount;
+				}
+				pxControl->uxReplenishmentFirst++;
+				if( schedSPORADIC_SERVER_MAX_REPLENISHMENTS == pxControl->uxReplenishmentFirst )
+				{
+					pxControl->uxReplenishmentFirst = 0;
+				}
+				pxControl->uxReplenishmentCounter--;
+			}
 		}
 
-		BaseType_t xEmptyIndex = xATCArrayLast;
+	#endif /* schedUSE_SPORADIC_SERVER */
 
-		/* Extend the ATC Array tail. */
-		xATCArrayLast++;
-		if( schedMAX_NUMBER_OF_APERIODIC_JOBS == xATCArrayLast )
+	#if( schedUSE_SPORADIC_SERVER == 1 || schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+		/* Blocks the server until a new job is submitted or the first queued
+		 * job is released. The Deferrable Server waits for the end of its
+		 * period as well, see prvDeferrableServerWait. */
+		static void prvServerWaitForJob( SchedTCB_t *pxServer )
 		{
-			xATCArrayLast = 0;        //restting ATC Array tail to 0 when end of array is reached
+			ServerControl_t *pxControl = pxServer->pxServerControl;
+			TickType_t xTimeout = portMAX_DELAY;
+
+			taskENTER_CRITICAL();
+			if( pxControl->uxAperiodicTaskCounter > 0 )
+			{
+				xTimeout = pxControl->xATCArray[ 0 ].xReleaseTime - xTaskGetTickCount();
+			}
+			taskEXIT_CRITICAL();
+
+			/* The first job may have been released in the meantime. */
+			if( ( SchedTickDiff_t ) xTimeout > 0 || portMAX_DELAY == xTimeout )
+			{
+				ulTaskNotifyTake( pdTRUE, xTimeout );
+			}
 		}
+	#endif /* schedUSE_SPORADIC_SERVER || schedUSE_TOTAL_BANDWIDTH_SERVER */
 
-		return xEmptyIndex;
-	}
+	#if( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+		/* Returns the time it takes to serve xExecTime ticks at bandwidth Us. */
+		static TickType_t prvTotalBandwidthServerBudgetTime( TickType_t xExecTime )
+		{
+			return ( xExecTime * 100 + schedTOTAL_BANDWIDTH_SERVER_UTILIZATION - 1 ) / schedTOTAL_BANDWIDTH_SERVER_UTILIZATION;
+		}
 
-	/* Creates an aperiodic job. */
-	void vSchedulerAperiodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters, TickType_t xMaxExecTimeTick, TickType_t xPhaseTick )
-	{
-		taskENTER_CRITICAL();
-	    BaseType_t xIndex = prvGetEmptyIndexATC();
-		if( -1 == xIndex)
+		/* Assigns the deadline of the given job to the server and gives it the
+		 * job's WCET as budget. The scheduler task reorders EDF priorities. */
+		static void prvTotalBandwidthServerDispatch( SchedTCB_t *pxServer, ATC_t *pxJob )
 		{
-			/* The ATC Array is full. */
+			TickType_t xStart = pxJob->xReleaseTime;
+			if( ( SchedTickDiff_t ) ( pxServer->xLastJobDeadline - xStart ) > 0 )
+			{
+				xStart = pxServer->xLastJobDeadline;
+			}
+			pxJob->xAbsoluteDeadline = xStart + prvTotalBandwidthServerBudgetTime( pxJob->xMaxExecTime );
+
+			taskENTER_CRITICAL();
+			pxServer->xLastJobDeadline = pxJob->xAbsoluteDeadline;
+			pxServer->xAbsoluteDeadline = pxJob->xAbsoluteDeadline;
+			pxServer->xMaxExecTime = pxJob->xMaxExecTime;
+			prvResetExecTime( pxServer );
 			taskEXIT_CRITICAL();
-			return;
+
+			xTaskNotifyGive( xSchedulerHandle );
 		}
-		configASSERT( uxAperiodicTaskCounter < schedMAX_NUMBER_OF_APERIODIC_JOBS );
-		ATC_t *pxNewATC = &xATCArray[ xIndex ];
-        
-		/* Add item to ATC Array. */
-		*pxNewATC = ( ATC_t ) { .pvTaskCode = pvTaskCode, .pcName = pcName, .pvParameters = pvParameters, .xReleaseTime = xPhaseTick, .xMaxExecTime = xMaxExecTimeTick, .xExecTime = 0, };
-		
-		uxAperiodicTaskCounter++;
-		taskEXIT_CRITICAL();
-	}
-#endif /* schedUSE_APERIODIC_JOBS */
+	#endif /* schedUSE_TOTAL_BANDWIDTH_SERVER */
 
-#if( schedUSE_POLLING_SERVER == 1 )
-	/* Function code for the Polling Server. */
-	static void prvPollingServerFunction( void )
-	{
-		for( ; ; )
+	#if( schedUSE_BACKGROUND_SERVICE == 1 )
+		/* Removes the released job that is served first from the queues of all
+		 * servers and returns it, or returns NULL and sets *pxTimeout to the
+		 * ticks until the next queued job is released. */
+		static ATC_t *prvBackgroundServiceTakeJob( TickType_t *pxTimeout )
 		{
-			#if( schedUSE_APERIODIC_JOBS == 1 )
-				pxCurrentAperiodicTask = prvGetNextAperiodicTask();
-				if( pxCurrentAperiodicTask == NULL )
+			ServerControl_t *pxFirst = NULL;
+			UBaseType_t uxServer;
+
+			for( uxServer = 0; uxServer < uxServerCounter; uxServer++ )
+			{
+				prvATCDrainISRQueue( &xServerArray[ uxServer ] );
+			}
+
+			taskENTER_CRITICAL();
+			TickType_t xTickCount = xTaskGetTickCount();
+			*pxTimeout = portMAX_DELAY;
+			for( uxServer = 0; uxServer < uxServerCounter; uxServer++ )
+			{
+				ServerControl_t *pxControl = &xServerArray[ uxServer ];
+				if( 0 == pxControl->uxAperiodicTaskCounter )
 				{
-					/* No ready aperiodic task in the queue. */
-					return;
+					continue;
 				}
-				else
+				const ATC_t *pxRoot = &pxControl->xATCArray[ 0 ];
+				if( ( SchedTickDiff_t ) ( pxRoot->xReleaseTime - xTickCount ) > 0 )
 				{
-					/* Run aperiodic task */
-					pxCurrentAperiodicTask->pvTaskCode( pxCurrentAperiodicTask->pvParameters );
-					uxAperiodicTaskCounter--;
+					if( ( SchedTickDiff_t ) ( pxRoot->xReleaseTime - xTickCount ) < ( SchedTickDiff_t ) *pxTimeout || portMAX_DELAY == *pxTimeout )
+					{
+						*pxTimeout = pxRoot->xReleaseTime - xTickCount;
+					}
 				}
-			#endif /* schedUSE_APERIODIC_JOBS */
+				else if( NULL == pxFirst || pdTRUE == prvATCIsBefore( pxRoot, &pxFirst->xATCArray[ 0 ] ) )
+				{
+					pxFirst = pxControl;
+				}
+			}
+			if( pxFirst != NULL )
+			{
+				prvATCHeapPop( pxFirst, &xBackgroundJob );
+			}
+			taskEXIT_CRITICAL();
+
+			return ( pxFirst != NULL ) ? &xBackgroundJob : NULL;
+		}
+
+		#if( schedUSE_SLACK_STEALING == 1 )
+			/* pdTRUE if every level has slack for more than the tick it takes
+			 * the scheduler task to lower the background service again. */
+			static BaseType_t prvSlackAvailable( void )
+			{
+				BaseType_t xIndex;
+
+				for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+				{
+					if( pxActiveTCBs[ xIndex ]->xSlack <= 1 )
+					{
+						return pdFALSE;
+					}
+				}
+				return pdTRUE;
+			}
+
+			/* Called every tick with the task that ran. Time stolen by the
+			 * background service is charged to every level. A level whose
+			 * tasks all wait while a task of lower priority runs is idle, so
+			 * its busy period has ended and its slack is restored. */
+			static void prvSlackStealingTick( TaskHandle_t xCurrentTask )
+			{
+				BaseType_t xIndex;
+
+				if( xCurrentTask == xBackgroundHandle && pdTRUE == xSlackStealing )
+				{
+					for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+					{
+						if( pxActiveTCBs[ xIndex ]->xSlack > 0 )
+						{
+							pxActiveTCBs[ xIndex ]->xSlack--;
+						}
+					}
+					if( pdFALSE == prvSlackAvailable() )
+					{
+						xSlackStealing = pdFALSE;
+						xSlackExhausted = pdTRUE;
+						prvWakeScheduler();
+					}
+				}
+				else if( xCurrentTask != xSchedulerHandle )
+				{
+					UBaseType_t uxLevel = uxTaskPriorityGetFromISR( xCurrentTask );
+					for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+					{
+						SchedTCB_t *pxTCB = pxActiveTCBs[ xIndex ];
+						if( pxTCB->uxPriority > uxLevel )
+						{
+							pxTCB->xSlack = pxTCB->xStaticSlack;
+						}
+					}
+				}
+			}
+		#endif /* schedUSE_SLACK_STEALING */
+
+		/* Function code for the background service. Runs released aperiodic
+		 * jobs at tskIDLE_PRIORITY, i.e. only while no periodic task, server or
+		 * worker is ready. With slack stealing the service waits for jobs at
+		 * the scheduler priority and keeps it for a job if every level has
+		 * slack left. A job taken here leaves its server's queue. */
+		static void prvBackgroundServiceFunction( void *pvParameters )
+		{
+			TickType_t xTimeout;
+
+			for( ; ; )
+			{
+				ATC_t *pxJob = prvBackgroundServiceTakeJob( &xTimeout );
+				if( NULL == pxJob )
+				{
+					#if( schedUSE_SLACK_STEALING == 1 )
+						/* Checks a released job for slack at once. */
+						vTaskPrioritySet( NULL, schedSCHEDULER_PRIORITY );
+					#endif /* schedUSE_SLACK_STEALING */
+					ulTaskNotifyTake( pdTRUE, xTimeout );
+					continue;
+				}
+
+				#if( schedUSE_SLACK_STEALING == 1 )
+					taskENTER_CRITICAL();
+					xSlackStealing = prvSlackAvailable();
+					vTaskPrioritySet( NULL, ( pdTRUE == xSlackStealing ) ? schedSCHEDULER_PRIORITY : tskIDLE_PRIORITY );
+					taskEXIT_CRITICAL();
+				#endif /* schedUSE_SLACK_STEALING */
+
+				TickType_t xStartTime = xTaskGetTickCount();
+				schedTRACE_EVENT_HOOK( schedTRACE_EVENT_START, pxJob->pcName, xStartTime );
+				pxJob->pvTaskCode( pxJob->pvParameters );
+				TickType_t xEndTime = xTaskGetTickCount();
+				schedTRACE_EVENT_HOOK( schedTRACE_EVENT_END, pxJob->pcName, xEndTime );
+
+				#if( schedUSE_SLACK_STEALING == 1 )
+					taskENTER_CRITICAL();
+					xSlackStealing = pdFALSE;
+					xSlackExhausted = pdFALSE;
+					taskEXIT_CRITICAL();
+				#endif /* schedUSE_SLACK_STEALING */
+
+				#if( schedUSE_TASK_STATISTICS == 1 )
+					/* Servers preempt this task and record their jobs too. */
+					taskENTER_CRITICAL();
+					prvStatsRecordJob( &xAperiodicStats, pxJob->xExecTime, xEndTime - pxJob->xReleaseTime, xStartTime - pxJob->xReleaseTime );
+					taskEXIT_CRITICAL();
+				#endif /* schedUSE_TASK_STATISTICS */
+			}
 		}
-	}
 
-	/* Creates Polling Server as a periodic task. */
-	void prvCreatePollingServer( void )
+		/* Creates the background service task. */
+		static void prvCreateBackgroundServiceTask( void )
+		{
+			#if( schedUSE_STATIC_ALLOCATION == 1 )
+				static StaticTask_t xBackgroundTaskBuffer;
+				static StackType_t xBackgroundStack[ schedBACKGROUND_SERVICE_STACK_SIZE ];
+				xBackgroundHandle = xTaskCreateStatic( prvBackgroundServiceFunction, "BG", schedBACKGROUND_SERVICE_STACK_SIZE, NULL, tskIDLE_PRIORITY,
+						xBackgroundStack, &xBackgroundTaskBuffer );
+			#else
+				xTaskCreate( prvBackgroundServiceFunction, "BG", schedBACKGROUND_SERVICE_STACK_SIZE, NULL, tskIDLE_PRIORITY, &xBackgroundHandle );
+			#endif /* schedUSE_STATIC_ALLOCATION */
+		}
+	#endif /* schedUSE_BACKGROUND_SERVICE */
+
+	/* Creates a server as a periodic task. Returns the number of the server,
+	 * or -1 if there is no free server or TCB. */
+	static BaseType_t prvCreateServer( const char *pcName, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick )
 	{
 		taskENTER_CRITICAL();
 	SchedTCB_t *pxNewTCB;
 		#if( schedUSE_TCB_ARRAY == 1 )
-			BaseType_t xIndex = prvFindEmptyElementIndexTCB();
-			configASSERT( xTaskCounter < schedMAX_NUMBER_OF_PERIODIC_TASKS );
-			configASSERT( xIndex != -1 );
+			BaseType_t xIndex = prvFindEmptyElementIndexTCB( schedPOLLING_SERVER_STACK_SIZE );
+			if( -1 == xIndex || schedMAX_NUMBER_OF_SERVERS == uxServerCounter )
+			{
+				taskEXIT_CRITICAL();
+				return -1;
+			}
 			pxNewTCB = &xTCBArray[ xIndex ];
 		#endif /* schedUSE_TCB_ARRAY */
+		BaseType_t xServer = ( BaseType_t ) uxServerCounter;
+		ServerControl_t *pxControl = &xServerArray[ xServer ];
 
 		/* Initialize item. */
-		//*pxNewTCB = ( SchedTCB_t ) { .pvTaskCode = (TaskFunction_t) prvPollingServerFunction, .pcName = "PS", .uxStackDepth = schedPOLLING_SERVER_STACK_SIZE, .pvParameters = NULL, 
+		//*pxNewTCB = ( SchedTCB_t ) { .pvTaskCode = (TaskFunction_t) prvPollingServerFunction, .pcName = "PS", .usStackDepth = schedPOLLING_SERVER_STACK_SIZE, .pvParameters = NULL, 
 			//.uxPriority = 4, .pxTaskHandle = &xPollingServerHandle, .xReleaseTime = 0, .xRelativeDeadline = schedPOLLING_SERVER_DEADLINE, .xAbsoluteDeadline = pxNewTCB->xReleaseTime + xSystemStartTime + pxNewTCB->xRelativeDeadline, 
 			//.xPeriod = schedPOLLING_SERVER_PERIOD, .xLastWakeTime = 0, .xMaxExecTime = schedPOLLING_SERVER_MAX_EXECUTION_TIME, .xExecTime = 0, .xWorkIsDone = pdTRUE, .xIsPollingServer = pdTRUE };   
 			//put in ino
     
 		pxNewTCB->pvTaskCode = (TaskFunction_t) prvPollingServerFunction;
-		pxNewTCB->pcName = "PS";
-		pxNewTCB->uxStackDepth = schedPOLLING_SERVER_STACK_SIZE;
+		pxNewTCB->pcName = pcName;
+		pxNewTCB->usStackDepth = schedPOLLING_SERVER_STACK_SIZE;
 		pxNewTCB->pvParameters = NULL;
 		pxNewTCB->uxPriority = 0;
-		pxNewTCB->pxTaskHandle = &xPollingServerHandle;
+		pxNewTCB->pxTaskHandle = &pxControl->xHandle;
 		pxNewTCB->xReleaseTime = 0;
-		pxNewTCB->xRelativeDeadline = schedPOLLING_SERVER_DEADLINE;
+		pxNewTCB->xRelativeDeadline = xDeadlineTick;
 		pxNewTCB->xAbsoluteDeadline = pxNewTCB->xReleaseTime + xSystemStartTime + pxNewTCB->xRelativeDeadline;
-		pxNewTCB->xMaxExecTime = schedPOLLING_SERVER_MAX_EXECUTION_TIME;
+		pxNewTCB->xMaxExecTime = xMaxExecTimeTick;
 		pxNewTCB->xExecTime = 0;
 		pxNewTCB->xWorkIsDone = pdTRUE;
-		pxNewTCB->xPeriod = schedPOLLING_SERVER_PERIOD; 
+		pxNewTCB->xPeriod = xPeriodTick; 
 	    
 		#if( schedUSE_TCB_ARRAY == 1 )
 			pxNewTCB->xInUse = pdTRUE;
 		#endif /*schedUSE_TCB_ARRAY */
         
-		#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
-			pxNewTCB->xPriorityIsSet = pdFALSE;
-		#endif /* schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY_DMS */
-
 		#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
 			pxNewTCB->xSuspended = pdFALSE;
 			pxNewTCB->xMaxExecTimeExceeded = pdFALSE;
 		#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
 		pxNewTCB->xIsPollingServer = pdTRUE;
+		pxNewTCB->pxServerControl = pxControl;
+		pxControl->xHandle = NULL;
+		pxControl->pxTCB = pxNewTCB;
+		#if( schedUSE_APERIODIC_JOBS == 1 )
+			pxControl->uxAperiodicTaskCounter = 0;
+			pxControl->ucATCISRQueueHead = 0;
+			pxControl->ucATCISRQueueTail = 0;
+		#endif /* schedUSE_APERIODIC_JOBS */
+		#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+			pxControl->xAperiodicWorkerHandle = NULL;
+			pxControl->xAperiodicJobDone = pdTRUE;
+			pxControl->xAperiodicJobOverrun = pdFALSE;
+			#if( schedUSE_STACK_PROFILING == 1 )
+				pxControl->xWorkerStackProfile = ( StackProfile_t ) { "AW", &pxControl->xAperiodicWorkerHandle, schedAPERIODIC_WORKER_STACK_SIZE,
+						schedAPERIODIC_WORKER_STACK_SIZE };
+			#endif /* schedUSE_STACK_PROFILING */
+		#endif /* schedUSE_APERIODIC_WORKER_TASK */
+		#if( schedUSE_SPORADIC_SERVER == 1 )
+			pxControl->uxReplenishmentFirst = 0;
+			pxControl->uxReplenishmentCounter = 0;
+		#endif /* schedUSE_SPORADIC_SERVER */
+		#if( schedUSE_SPORADIC_SERVER == 1 )
+			pxNewTCB->xChunkActive = pdFALSE;
+			pxNewTCB->xChunkStartTime = 0;
+			pxNewTCB->xChunkStartExecTime = 0;
+		#endif /* schedUSE_SPORADIC_SERVER */
+		#if( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+			pxNewTCB->xLastJobDeadline = 0;
+		#endif /* schedUSE_TOTAL_BANDWIDTH_SERVER */
+		#if( schedUSE_TASK_STATISTICS == 1 )
+			prvStatsInit( &pxNewTCB->xStatsCollector );
+			pxNewTCB->xExecTimeCarry = 0;
+		#endif /* schedUSE_TASK_STATISTICS */
+		#if( schedUSE_STACK_PROFILING == 1 )
+			pxNewTCB->usStackHighWaterMark = pxNewTCB->usStackDepth;
+		#endif /* schedUSE_STACK_PROFILING */
+		#if( schedUSE_MODES == 1 )
+			prvModeParamsInit( pxNewTCB );
+		#endif /* schedUSE_MODES */
 	
 		#if( schedUSE_TCB_ARRAY == 1 )
-			xTaskCounter++;
+			prvAddTCBToArray( pxNewTCB );
 		#endif /* schedUSE_TCB_ARRAY */
+		uxServerCounter++;
 		taskEXIT_CRITICAL();
+		return xServer;
 	}
 
+	/* Creates a further server before the scheduler starts. */
+	BaseType_t xSchedulerServerCreate( const char *pcName, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick )
+	{
+		configASSERT( pdFALSE == xSchedulerStarted );
+		BaseType_t xServer = prvCreateServer( pcName, xPeriodTick, xMaxExecTimeTick, xDeadlineTick );
+		#if( schedUSE_TASK_TABLE == 1 )
+			/* The priorities of a task table do not account for the server. */
+			if( xServer != -1 )
+			{
+				xTaskTableInUse = pdFALSE;
+			}
+		#endif /* schedUSE_TASK_TABLE */
+		return xServer;
+	}
+
+	#if( schedUSE_TASK_STATISTICS == 1 )
+		/* Copies the statistics of a server. */
+		void vSchedulerGetServerStats( UBaseType_t uxServer, SchedTaskStats_t *pxStats )
+		{
+			configASSERT( uxServer < uxServerCounter );
+			prvStatsCopy( &xServerArray[ uxServer ].pxTCB->xStatsCollector, pxStats );
+		}
+
+		#if( schedUSE_APERIODIC_JOBS == 1 )
+			/* Copies the statistics of all aperiodic jobs. */
+			void vSchedulerGetAperiodicStats( SchedTaskStats_t *pxStats )
+			{
+				prvStatsCopy( &xAperiodicStats, pxStats );
+			}
+		#endif /* schedUSE_APERIODIC_JOBS */
+	#endif /* schedUSE_TASK_STATISTICS */
+
 
 #endif /* schedUSE_POLLING_SERVER */
 
+	#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+		/* Returns the number of ticks until xTime, or 0 if it has passed. */
+		static TickType_t prvTimeUntil( TickType_t xTime, TickType_t xTickCount )
+		{
+			return ( ( SchedTickDiff_t ) ( xTime - xTickCount ) <= 0 ) ? 0 : xTime - xTickCount;
+		}
+
+		/* Returns the number of ticks until the scheduler task has to check the
+		 * given task, 0 if a check is due now, or portMAX_DELAY if there is
+		 * nothing to check. */
+		static TickType_t prvGetTimingEventDelay( SchedTCB_t *pxTCB, TickType_t xTickCount )
+		{
+			TickType_t xDelay = portMAX_DELAY;
+
+			#if( schedUSE_MODES == 1 )
+				/* Jobs released during a mode change are never started. */
+				if( pdTRUE == xModeChangePending && pdFALSE == pxTCB->xJobInProgress )
+				{
+					return xDelay;
+				}
+			#endif /* schedUSE_MODES */
+
+			#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )
+				#if( schedUSE_POLLING_SERVER == 1 )
+					if( pdFALSE == pxTCB->xIsPollingServer && pdTRUE == pxTCB->xExecutedOnce && pdFALSE == pxTCB->xDeadlineMissed )
+				#else
+					if( pdTRUE == pxTCB->xExecutedOnce && pdFALSE == pxTCB->xDeadlineMissed )
+				#endif /* schedUSE_POLLING_SERVER */
+					{
+						/* A miss is detected one tick after the absolute deadline. */
+						xDelay = prvTimeUntil( pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline + 1, xTickCount );
+					}
+			#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+
+			#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+				if( pdTRUE == pxTCB->xMaxExecTimeExceeded )
+				{
+					xDelay = 0;
+				}
+				else if( pdTRUE == pxTCB->xSuspended )
+				{
+					TickType_t xUnblockDelay = prvTimeUntil( pxTCB->xAbsoluteUnblockTime, xTickCount );
+					if( xUnblockDelay < xDelay )
+					{
+						xDelay = xUnblockDelay;
+					}
+				}
+			#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+
+			return xDelay;
+		}
+	#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+
 	/* Function code for the scheduler task. */
 	static void prvSchedulerFunction( void *pvParameters )
 	{
 
 		for( ; ; )
 		{ 
+			TickType_t xNextEventDelay = schedSCHEDULER_TASK_PERIOD;
+
+			#if( schedUSE_MODES == 1 )
+				/* Woken on the request and whenever a job completes meanwhile. */
+				if( pdTRUE == xModeChangePending )
+				{
+					prvModeChangeApply();
+				}
+			#endif /* schedUSE_MODES */
 			
      		#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
 				TickType_t xTickCount = xTaskGetTickCount();
         		SchedTCB_t *pxTCB;
         		for(BaseType_t xIndex=0;xIndex<xTaskCounter;xIndex++){
-        			pxTCB = &xTCBArray[xIndex];
-        			if ((pxTCB) && (pxTCB->xInUse == pdTRUE)&&(pxTCB->pxTaskHandle != NULL)) {
-                    	prvSchedulerCheckTimingError( xTickCount, pxTCB );
+        			pxTCB = pxActiveTCBs[xIndex];
+        			if (*pxTCB->pxTaskHandle != NULL) {
+						/* Only tasks with a due event are processed. */
+						TickType_t xDelay = prvGetTimingEventDelay( pxTCB, xTickCount );
+						if( 0 == xDelay )
+						{
+                    		prvSchedulerCheckTimingError( xTickCount, pxTCB );
+							xDelay = prvGetTimingEventDelay( pxTCB, xTickCount );
+						}
+						if( xDelay < xNextEventDelay )
+						{
+							xNextEventDelay = xDelay;
+						}
                     }
               	}
 			
 			#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
+			#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+				for( UBaseType_t uxServer = 0; uxServer < uxServerCounter; uxServer++ )
+				{
+					if( pdTRUE == xServerArray[ uxServer ].xAperiodicJobOverrun )
+					{
+						prvAbortAperiodicJob( &xServerArray[ uxServer ] );
+					}
+				}
+			#endif /* schedUSE_APERIODIC_WORKER_TASK */
+
+			#if( schedBACKGROUND_STEALS_SLACK )
+				/* Woken by the tick hook when the slack has run out. */
+				taskENTER_CRITICAL();
+				if( pdTRUE == xSlackExhausted )
+				{
+					xSlackExhausted = pdFALSE;
+					vTaskPrioritySet( xBackgroundHandle, tskIDLE_PRIORITY );
+				}
+				taskEXIT_CRITICAL();
+			#endif /* schedBACKGROUND_STEALS_SLACK */
+
+			#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+				/* Woken on every job completion, so deadlines are up to date. */
+				prvUpdatePrioritiesEDF();
+			#endif /* schedSCHEDULING_POLICY_EDF */
+
+			/* An event that occurs before blocking leaves a pending notification,
+			 * so nothing is lost between here and ulTaskNotifyTake. A zero delay
+			 * (check still due, e.g. suspension of a running task) retries next tick. */
+			taskENTER_CRITICAL();
+			xSchedulerNextWakeTime = xTaskGetTickCount() + ( xNextEventDelay > 0 ? xNextEventDelay : 1 );
+			xSchedulerWakeArmed = pdTRUE;
+			taskEXIT_CRITICAL();
+
 			ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
 		}
 	}
@@ -752,7 +3658,14 @@ static void prvSetFixedPriorities( void )
 	/* Creates the scheduler task. */
 	static void prvCreateSchedulerTask( void )
 	{
-		xTaskCreate( (TaskFunction_t) prvSchedulerFunction, "Scheduler", schedSCHEDULER_TASK_STACK_SIZE, NULL, schedSCHEDULER_PRIORITY, &xSchedulerHandle );
+		#if( schedUSE_STATIC_ALLOCATION == 1 )
+			static StaticTask_t xSchedulerTaskBuffer;
+			static StackType_t xSchedulerStack[ schedSCHEDULER_TASK_STACK_SIZE ];
+			xSchedulerHandle = xTaskCreateStatic( (TaskFunction_t) prvSchedulerFunction, "Scheduler", schedSCHEDULER_TASK_STACK_SIZE, NULL, schedSCHEDULER_PRIORITY,
+					xSchedulerStack, &xSchedulerTaskBuffer );
+		#else
+			xTaskCreate( (TaskFunction_t) prvSchedulerFunction, "Scheduler", schedSCHEDULER_TASK_STACK_SIZE, NULL, schedSCHEDULER_PRIORITY, &xSchedulerHandle );
+		#endif /* schedUSE_STATIC_ALLOCATION */
 	
 	}
 #endif /* schedUSE_SCHEDULER_TASK */
@@ -767,36 +3680,95 @@ static void prvSetFixedPriorities( void )
 		xTaskResumeFromISR(xSchedulerHandle);    
 	}
 
+	/* Makes the tick hook wake the scheduler task at xWakeTime at the latest.
+	 * Called from task context. */
+	static void prvSchedulerRequestWake( TickType_t xWakeTime )
+	{
+		taskENTER_CRITICAL();
+		if( pdFALSE == xSchedulerWakeArmed || ( SchedTickDiff_t ) ( xWakeTime - xSchedulerNextWakeTime ) < 0 )
+		{
+			xSchedulerNextWakeTime = xWakeTime;
+			xSchedulerWakeArmed = pdTRUE;
+		}
+		taskEXIT_CRITICAL();
+	}
+
 	/* Called every software tick. */
 	// In FreeRTOSConfig.h,
 	// Enable configUSE_TICK_HOOK
-	// Enable INCLUDE_xTaskGetIdleTaskHandle
 	// Enable INCLUDE_xTaskGetCurrentTaskHandle
+	// Set configNUM_THREAD_LOCAL_STORAGE_POINTERS > schedTHREAD_LOCAL_STORAGE_POINTER_INDEX
+	// With schedUSE_STATIC_ALLOCATION, enable configSUPPORT_STATIC_ALLOCATION and
+	// provide vApplicationGetIdleTaskMemory, and vApplicationGetTimerTaskMemory
+	// with configUSE_TIMERS, unless the port defines them
 	
 	void vApplicationTickHook( void )
 	{            
-		SchedTCB_t *pxCurrentTask;		
-		TaskHandle_t xCurrentTaskHandle = xTaskGetCurrentTaskHandle();		
-        UBaseType_t flag = 0;
-        BaseType_t xIndex;
-		BaseType_t prioCurrentTask = uxTaskPriorityGet(xCurrentTaskHandle);
-
-		for(xIndex = 0; xIndex < xTaskCounter ; xIndex++){
-			pxCurrentTask = &xTCBArray[xIndex];
-			if(pxCurrentTask -> uxPriority == prioCurrentTask){
-				flag = 1;
-				break;
-			}
-		}
+		/* Idle and scheduler task carry no extended TCB, so they are skipped. */
+		SchedTCB_t *pxCurrentTask = prvGetTCBFromHandle( xTaskGetCurrentTaskHandle() );
+
+		#if( schedBACKGROUND_STEALS_SLACK )
+			prvSlackStealingTick( xTaskGetCurrentTaskHandle() );
+		#endif /* schedBACKGROUND_STEALS_SLACK */
     
-		if( xCurrentTaskHandle != xSchedulerHandle && xCurrentTaskHandle != xTaskGetIdleTaskHandle() && flag == 1)
+		#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+			/* Charge the current job against its own WCET as well. Workers
+			 * share the TCB of their server. */
+			if( pxCurrentTask != NULL && pdTRUE == pxCurrentTask->xIsPollingServer )
+			{
+				ServerControl_t *pxControl = pxCurrentTask->pxServerControl;
+				if( xTaskGetCurrentTaskHandle() == pxControl->xAperiodicWorkerHandle && pdFALSE == pxControl->xAperiodicJobDone )
+				{
+					pxControl->pxCurrentAperiodicTask->xExecTime++;
+					if( pxControl->pxCurrentAperiodicTask->xMaxExecTime <= pxControl->pxCurrentAperiodicTask->xExecTime &&
+							pdFALSE == pxControl->xAperiodicJobOverrun )
+					{
+						pxControl->xAperiodicJobOverrun = pdTRUE;
+						prvWakeScheduler();
+					}
+				}
+			}
+		#endif /* schedUSE_APERIODIC_WORKER_TASK */
+
+		#if( schedUSE_POLLING_SERVER == 1 && schedUSE_BACKGROUND_SERVICE == 1 )
+			if( xTaskGetCurrentTaskHandle() == xBackgroundHandle )
+			{
+				xBackgroundJob.xExecTime++;
+			}
+		#endif /* schedUSE_BACKGROUND_SERVICE */
+
+		#if( schedUSE_POLLING_SERVER == 1 && schedUSE_SPORADIC_SERVER == 1 )
+			for( UBaseType_t uxServer = 0; uxServer < uxServerCounter; uxServer++ )
+			{
+				if( xServerArray[ uxServer ].xHandle != NULL )
+				{
+					prvSporadicServerReplenish( xServerArray[ uxServer ].pxTCB, xTaskGetTickCountFromISR() );
+				}
+			}
+			/* An idle Sporadic Server does not consume budget. */
+			if( pxCurrentTask != NULL && pdTRUE == pxCurrentTask->xIsPollingServer && pdFALSE == pxCurrentTask->xChunkActive )
+			{
+				pxCurrentTask = NULL;
+			}
+		#endif /* schedUSE_SPORADIC_SERVER */
+
+		if( pxCurrentTask != NULL )
 		{
-			
-			
-			pxCurrentTask->xExecTime++;     
+			#if( schedUSE_PRECISE_EXECUTION_TIME == 0 )
+				pxCurrentTask->xExecTime++;
+			#endif /* schedUSE_PRECISE_EXECUTION_TIME */
      
 			#if( schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
-            if( pxCurrentTask->xMaxExecTime <= pxCurrentTask->xExecTime )
+				#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+					/* Earlier slices were charged at context switches, the
+					 * running one is still open. */
+					TickType_t xExecTime = prvGetExecTime( pxCurrentTask );
+					TickType_t xMaxExecTime = pxCurrentTask->xMaxExecTime * schedUS_PER_TICK;
+				#else
+					TickType_t xExecTime = pxCurrentTask->xExecTime;
+					TickType_t xMaxExecTime = pxCurrentTask->xMaxExecTime;
+				#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+            if( xMaxExecTime <= xExecTime )
             {
                 if( pdFALSE == pxCurrentTask->xMaxExecTimeExceeded )
                 {
@@ -809,35 +3781,168 @@ static void prvSetFixedPriorities( void )
 			#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 		}
 
-		#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 )    
-			xSchedulerWakeCounter++;      
-			if( xSchedulerWakeCounter == schedSCHEDULER_TASK_PERIOD )
+		#if( schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 )
+			/* O(1) per tick: the scheduler task has computed its next event. */
+			if( pdTRUE == xSchedulerWakeArmed && ( SchedTickDiff_t ) ( xTaskGetTickCountFromISR() - xSchedulerNextWakeTime ) >= 0 )
 			{
-				xSchedulerWakeCounter = 0;        
+				xSchedulerWakeArmed = pdFALSE;
 				prvWakeScheduler();
 			}
-		#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+		#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 	}
 #endif /* schedUSE_SCHEDULER_TASK */
 
+#if( schedUSE_STACK_PROFILING == 1 )
+	/* Lowers *pusHighWaterMark to the free stack of the given task. */
+	static void prvStackSample( TaskHandle_t xTaskHandle, configSTACK_DEPTH_TYPE *pusHighWaterMark )
+	{
+		if( xTaskHandle != NULL )
+		{
+			configSTACK_DEPTH_TYPE usFree = uxTaskGetStackHighWaterMark2( xTaskHandle );
+			if( usFree < *pusHighWaterMark )
+			{
+				*pusHighWaterMark = usFree;
+			}
+		}
+	}
+
+	static void prvStackFillUsage( const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, configSTACK_DEPTH_TYPE usHighWaterMark, SchedStackUsage_t *pxUsage )
+	{
+		uint32_t ulUsed = usStackDepth - usHighWaterMark;
+
+		pxUsage->pcName = pcName;
+		pxUsage->usStackDepth = usStackDepth;
+		pxUsage->usMaxUsed = ( configSTACK_DEPTH_TYPE ) ulUsed;
+		pxUsage->usRecommendedDepth = ( configSTACK_DEPTH_TYPE ) ( ulUsed + ( ulUsed * schedSTACK_MARGIN_PERCENT + 99 ) / 100 + schedSTACK_MARGIN_WORDS );
+	}
+
+	/* Reports the stack use of the task with the given index. */
+	BaseType_t xSchedulerGetStackUsage( UBaseType_t uxIndex, SchedStackUsage_t *pxUsage )
+	{
+		BaseType_t xIndex;
+
+		for( xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++ )
+		{
+			SchedTCB_t *pxTCB = &xTCBArray[ xIndex ];
+			if( pdTRUE == pxTCB->xInUse && 0 == uxIndex-- )
+			{
+				prvStackSample( *pxTCB->pxTaskHandle, &pxTCB->usStackHighWaterMark );
+				prvStackFillUsage( pxTCB->pcName, pxTCB->usStackDepth, pxTCB->usStackHighWaterMark, pxUsage );
+				return pdPASS;
+			}
+		}
+
+		StackProfile_t *pxProfile = NULL;
+		#if( schedNUMBER_OF_SYSTEM_TASKS > 0 )
+			if( uxIndex < schedNUMBER_OF_SYSTEM_TASKS )
+			{
+				pxProfile = &xSystemStackProfiles[ uxIndex ];
+			}
+			uxIndex -= schedNUMBER_OF_SYSTEM_TASKS;
+		#endif /* schedNUMBER_OF_SYSTEM_TASKS */
+		#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+			if( NULL == pxProfile && uxIndex < uxServerCounter )
+			{
+				pxProfile = &xServerArray[ uxIndex ].xWorkerStackProfile;
+			}
+		#endif /* schedUSE_APERIODIC_WORKER_TASK */
+		if( NULL == pxProfile )
+		{
+			return pdFAIL;
+		}
+		prvStackSample( *pxProfile->pxTaskHandle, &pxProfile->usHighWaterMark );
+		prvStackFillUsage( pxProfile->pcName, pxProfile->usStackDepth, pxProfile->usHighWaterMark, pxUsage );
+		return pdPASS;
+	}
+
+	/* Prints the stack use of all tasks. */
+	void vSchedulerPrintStackReport( void )
+	{
+		SchedStackUsage_t xUsage;
+		UBaseType_t uxIndex;
+
+		for( uxIndex = 0; pdPASS == xSchedulerGetStackUsage( uxIndex, &xUsage ); uxIndex++ )
+		{
+			Serial.print(xUsage.pcName);
+			Serial.print(", Stack- ");
+			Serial.print(xUsage.usStackDepth);
+			Serial.print(", Used- ");
+			Serial.print(xUsage.usMaxUsed);
+			Serial.print(", Recommended- ");
+			Serial.println(xUsage.usRecommendedDepth);
+		}
+		Serial.flush();
+	}
+#endif /* schedUSE_STACK_PROFILING */
+
 /* This function must be called before any other function call from this module. */
 void vSchedulerInit( void )
 {
 	#if( schedUSE_TCB_ARRAY == 1 )
 		prvInitTCBArray();
 	#endif /* schedUSE_TCB_ARRAY */
+
+	#if( schedUSE_TASK_STATISTICS == 1 && schedUSE_APERIODIC_JOBS == 1 )
+		prvStatsInit( &xAperiodicStats );
+	#endif /* schedUSE_TASK_STATISTICS */
+
+	#if( schedUSE_POLLING_SERVER == 1 )
+		/* Created first so that admission control accounts for the server. */
+		BaseType_t xServer = prvCreateServer( "PS", schedPOLLING_SERVER_PERIOD, schedPOLLING_SERVER_MAX_EXECUTION_TIME, schedPOLLING_SERVER_DEADLINE );
+		configASSERT( 0 == xServer );
+		( void ) xServer;
+	#endif /* schedUSE_POLLING_SERVER */
 }
 
 /* Starts scheduling tasks. All periodic tasks (including polling server) must
  * have been created with API function before calling this function. */
 void vSchedulerStart( void )
 {
-    #if( schedUSE_POLLING_SERVER == 1 )
-		prvCreatePollingServer();
-	#endif /* schedUSE_POLLING_SERVER */
+	xSystemStartTime = xTaskGetTickCount();
+
+	#if( schedUSE_MODES == 1 )
+		prvModeEnter( uxCurrentMode );
+	#endif /* schedUSE_MODES */
 
 	#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
-		prvSetFixedPriorities();	
+		BaseType_t xPrioritiesSet = pdFALSE;
+		#if( schedUSE_TASK_TABLE == 1 )
+			/* Assigned and checked by the compiler. */
+			xPrioritiesSet = xTaskTableInUse;
+		#endif /* schedUSE_TASK_TABLE */
+		if( pdFALSE == xPrioritiesSet )
+		{
+			prvSetFixedPriorities( 0 );
+			#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+				if( pdFAIL == prvResponseTimeAnalysis() )
+				{
+					Serial.println("Task set is not schedulable");
+					Serial.flush();
+				}
+			#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+		}
+		#if( schedUSE_RESOURCES == 1 )
+			else
+			{
+				/* The compiler knows no critical sections. */
+				prvResourceUpdateCeilings();
+				#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+					if( pdFAIL == prvResponseTimeAnalysis() )
+					{
+						Serial.println("Task set is not schedulable");
+						Serial.flush();
+					}
+				#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+			}
+		#elif( schedBACKGROUND_STEALS_SLACK || schedUSE_PREEMPTION_THRESHOLDS == 1 )
+			else
+			{
+				/* Slack and thresholds follow from the response times. */
+				prvResponseTimeAnalysis();
+			}
+		#endif /* schedUSE_RESOURCES */
+	#elif( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+		prvUpdatePrioritiesEDF();
 	#endif /* schedSCHEDULING_POLICY */
 
 	#if( schedUSE_SCHEDULER_TASK == 1 )
@@ -845,8 +3950,23 @@ void vSchedulerStart( void )
 	#endif /* schedUSE_SCHEDULER_TASK */
 
 	prvCreateAllTasks();
-	  
-	xSystemStartTime = xTaskGetTickCount();
+	/* From now on periodic tasks are created and deleted one by one. */
+	xSchedulerStarted = pdTRUE;
+
+	#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+		for( UBaseType_t uxServer = 0; uxServer < uxServerCounter; uxServer++ )
+		{
+			prvCreateAperiodicWorker( &xServerArray[ uxServer ] );
+		}
+	#endif /* schedUSE_APERIODIC_WORKER_TASK */
+
+	#if( schedUSE_TRACE_BUFFER == 1 )
+		prvCreateTraceDrainTask();
+	#endif /* schedUSE_TRACE_BUFFER */
+
+	#if( schedUSE_POLLING_SERVER == 1 && schedUSE_BACKGROUND_SERVICE == 1 )
+		prvCreateBackgroundServiceTask();
+	#endif /* schedUSE_BACKGROUND_SERVICE */
 	
 	vTaskStartScheduler();
 }
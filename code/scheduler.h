@@ -29,11 +29,42 @@ extern "C" {
 /* The scheduling policy can be chosen from one of these. */
 #define schedSCHEDULING_POLICY_RMS 1 
 #define schedSCHEDULING_POLICY_DMS 2		
+/* Earliest-deadline-first scheduling. Priorities are reassigned by the
+ * scheduler task whenever a job completes or a deadline is moved. */
+#define schedSCHEDULING_POLICY_EDF 3
 /* Rate-monotonic scheduling */
 
 /* Configure scheduling policy by setting this define to the appropriate one. */
 #define schedSCHEDULING_POLICY schedSCHEDULING_POLICY_RMS 
-//schedSCHEDULING_POLICY_EDF
+
+#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS )
+	/* Set this define to 1 to compute the worst-case response time of every
+	 * periodic task, including the Polling Server, when vSchedulerStart is
+	 * called, and to enable xSchedulerPeriodicTaskAdmit. */
+	#define schedUSE_RESPONSE_TIME_ANALYSIS 1
+#else
+	#define schedUSE_RESPONSE_TIME_ANALYSIS 0
+#endif /* schedSCHEDULING_POLICY */
+
+#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+	/* Set this define to 1 to enable task tables, a task set declared at
+	 * compile time whose priorities and response times are computed by the
+	 * compiler. See xSchedulerTaskTableBuild. */
+	#define schedUSE_TASK_TABLE 1
+	/* Set this define to 1 to give every periodic task a preemption
+	 * threshold. A started job runs at its threshold, so tasks with a
+	 * priority up to the threshold wait for it to complete instead of
+	 * preempting it. This saves context switches, and tasks that cannot
+	 * preempt one another never hold a job's stack at the same time. The
+	 * thresholds are raised as far as the response time analysis stays
+	 * schedulable whenever the task set changes. Servers keep their
+	 * priority. FreeRTOS time slices tasks of equal priority, so thresholds
+	 * only use levels no other task runs at, see schedPRIORITY_STRIDE. */
+	#define schedUSE_PREEMPTION_THRESHOLDS 0
+#else
+	#define schedUSE_TASK_TABLE 0
+	#define schedUSE_PREEMPTION_THRESHOLDS 0
+#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
 /* Maximum number of periodic tasks that can be created. (Scheduler task is
  * not included) */
 #define schedMAX_NUMBER_OF_PERIODIC_TASKS 3
@@ -51,18 +82,154 @@ extern "C" {
 #if ( schedUSE_APERIODIC_JOBS == 1 )
 	/* Maximum number of aperiodic jobs. */
 	#define schedMAX_NUMBER_OF_APERIODIC_JOBS 3
+	/* Number of slots of the lock-free ring that takes jobs submitted from
+	 * interrupt handlers. Must be a power of two, at most 128. */
+	#define schedAPERIODIC_ISR_QUEUE_LENGTH 4
+	/* Set this define to 1 to run aperiodic jobs on a worker task instead of
+	 * the server's own context. When the server runs out of budget only the
+	 * worker is paused, and the same job continues in the next server
+	 * instance. Each job's WCET is enforced separately: a job that exceeds it
+	 * is aborted. Requires Timing-Error-Detection of execution time. */
+	#define schedUSE_APERIODIC_WORKER_TASK 0
+	#if( schedUSE_APERIODIC_WORKER_TASK == 1 )
+		/* Stack size of the aperiodic worker task. */
+		#define schedAPERIODIC_WORKER_STACK_SIZE 500
+	#endif /* schedUSE_APERIODIC_WORKER_TASK */
+	/* Set this define to 1 to serve released aperiodic jobs in the
+	 * background whenever the CPU would otherwise be idle. A task at
+	 * tskIDLE_PRIORITY takes jobs off the server queues and runs them to
+	 * completion without consuming server budget; their WCET is not
+	 * enforced. Periodic tasks and servers keep priorities above
+	 * tskIDLE_PRIORITY, so their guarantees are unchanged. */
+	#define schedUSE_BACKGROUND_SERVICE 0
+	#if( schedUSE_BACKGROUND_SERVICE == 1 )
+		/* Stack size of the background service task. */
+		#define schedBACKGROUND_SERVICE_STACK_SIZE 500
+		/* Set this define to 1 to let the background service steal slack
+		 * under RMS or DMS. While every periodic task and server can still
+		 * absorb the delay, a job is run at the scheduler priority, above all
+		 * of them, instead of waiting for idle time. The slack of each task
+		 * follows from its response time analysis and is tracked per tick.
+		 * A job that runs out of slack finishes in the background. Periodic
+		 * tasks start one priority below the scheduler task, so a task set
+		 * may need a larger configMAX_PRIORITIES to stay schedulable; no
+		 * slack is stolen from an unschedulable one. Requires the scheduler
+		 * task and schedUSE_RESPONSE_TIME_ANALYSIS. */
+		#define schedUSE_SLACK_STEALING 0
+	#endif /* schedUSE_BACKGROUND_SERVICE */
 #endif /* schedUSE_APERIODIC_JOBS */
 
+/* Lowest priority given to periodic tasks and servers. tskIDLE_PRIORITY is
+ * left to the background service if it is enabled. */
+#if( schedUSE_APERIODIC_JOBS == 1 && schedUSE_BACKGROUND_SERVICE == 1 )
+	#define schedLOWEST_TASK_PRIORITY ( tskIDLE_PRIORITY + 1 )
+#else
+	#define schedLOWEST_TASK_PRIORITY tskIDLE_PRIORITY
+#endif /* schedUSE_BACKGROUND_SERVICE */
+
 /* Set this define to 1 to enable Timing-Error-Detection for detecting tasks
- * that have missed their deadlines. Tasks that have missed their deadlines
- * will be deleted, recreated and restarted during next period. */
+ * that have missed their deadlines. What happens to a task that has missed
+ * its deadline is chosen per task with one of the schedMISS_POLICY_* below. */
 #define schedUSE_TIMING_ERROR_DETECTION_DEADLINE 1
 
+/* Deadline miss policies of periodic tasks. */
+/* The late job is aborted. The task restarts on its own TCB and stack and
+ * is released at the next release time of its original schedule. */
+#define schedMISS_POLICY_ABORT_JOB 0
+/* The late job runs to completion. Releases that passed meanwhile are
+ * skipped and the next job is released at the next release time of the
+ * original schedule. */
+#define schedMISS_POLICY_SKIP_NEXT 1
+/* The late job runs to completion. The next job is released as soon as it
+ * completes and later releases follow from there. */
+#define schedMISS_POLICY_CONTINUE 2
+
 /* Set this define to 1 to enable Timing-Error-Detection for detecting tasks
  * that have exceeded their worst-case execution time. Tasks that have exceeded
  * their worst-case execution time will be preempted until next period. */
 #define schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME 1
 
+/* Set this define to 1 to measure execution times with a microsecond clock
+ * at every context switch instead of charging a whole tick to the task that
+ * is running when the tick interrupt occurs. Requires in FreeRTOSConfig.h:
+ *   void vSchedulerTaskSwitchedIn( void );
+ *   void vSchedulerTaskSwitchedOut( void );
+ *   #define traceTASK_SWITCHED_IN() vSchedulerTaskSwitchedIn()
+ *   #define traceTASK_SWITCHED_OUT() vSchedulerTaskSwitchedOut()
+ * Not supported by the Sporadic Server and the Total Bandwidth Server. */
+#define schedUSE_PRECISE_EXECUTION_TIME 0
+
+#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+	/* Free running microsecond clock. micros() counts on Timer0, which
+	 * Arduino_FreeRTOS leaves to the Arduino core because its tick comes from
+	 * the watchdog timer. */
+	#ifndef schedCLOCK_US
+		#define schedCLOCK_US() micros()
+	#endif
+	/* Length of a software tick in microseconds. */
+	#define schedUS_PER_TICK ( 1000000UL / configTICK_RATE_HZ )
+#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+
+/* Set this define to 1 to record scheduler events (job start and end,
+ * deadline miss, overrun, suspend, resume) as fixed-size binary records in a
+ * ring buffer. A drain task at the lowest priority prints them over Serial,
+ * so no Serial output is produced inside the timed code paths. With 0 the
+ * events are printed where they occur. */
+#define schedUSE_TRACE_BUFFER 1
+
+#if( schedUSE_TRACE_BUFFER == 1 )
+	/* Number of records in the trace buffer. Must be a power of two, at most 128. */
+	#define schedTRACE_BUFFER_LENGTH 32
+	/* Stack size of the trace drain task. */
+	#define schedTRACE_DRAIN_TASK_STACK_SIZE 200
+	/* The drain task empties the buffer with this period in software ticks. */
+	#define schedTRACE_DRAIN_PERIOD pdMS_TO_TICKS( 100 )
+#endif /* schedUSE_TRACE_BUFFER */
+
+/* Set this define to 1 to collect timing statistics of every periodic task,
+ * the Polling Server and the aperiodic jobs. Each update takes constant time
+ * and no memory is allocated. */
+#define schedUSE_TASK_STATISTICS 1
+
+#if( schedUSE_TASK_STATISTICS == 1 )
+	/* Number of buckets of the response time histogram. */
+	#define schedSTATS_HISTOGRAM_BUCKETS 8
+	/* Width of a histogram bucket in software ticks. */
+	#define schedSTATS_HISTOGRAM_BUCKET_WIDTH pdMS_TO_TICKS( 250 )
+#endif /* schedUSE_TASK_STATISTICS */
+
+/* Set this define to 1 to create every task of this library with
+ * xTaskCreateStatic. FreeRTOS TCBs are kept in the extended TCBs and stacks
+ * in static buffers, so no heap is used and recovery from a deadline miss
+ * reuses the same memory. Requires configSUPPORT_STATIC_ALLOCATION, which
+ * in turn needs vApplicationGetIdleTaskMemory, see vApplicationTickHook. */
+#define schedUSE_STATIC_ALLOCATION 1
+
+#if( schedUSE_STATIC_ALLOCATION == 1 )
+	/* Stack words shared by all periodic tasks and the Polling Server. A
+	 * stack is taken when a task is first created and stays with its TCB, a
+	 * deleted task leaves it to the next task that fits in it. */
+	#define schedSTATIC_STACK_POOL_SIZE 2600
+#endif /* schedUSE_STATIC_ALLOCATION */
+
+/* Set this define to 1 to track the stack high water mark of every task of
+ * this library, including the scheduler task, and to report recommended
+ * stack sizes. Requires INCLUDE_uxTaskGetStackHighWaterMark2, whose result
+ * is not truncated to 8 bits on the ATmega2560. */
+#define schedUSE_STACK_PROFILING 0
+
+#if( schedUSE_STACK_PROFILING == 1 )
+	/* A recommended stack size exceeds the deepest use seen by this
+	 * percentage plus a number of words for the context of an interrupt. */
+	#define schedSTACK_MARGIN_PERCENT 25
+	#define schedSTACK_MARGIN_WORDS 40
+#endif /* schedUSE_STACK_PROFILING */
+
+/* Index of the thread local storage pointer that maps a task handle to its
+ * extended TCB. configNUM_THREAD_LOCAL_STORAGE_POINTERS must be greater than
+ * this index. */
+#define schedTHREAD_LOCAL_STORAGE_POINTER_INDEX 0
+
 /* Set this define to 1 to enable the scheduler task. This define must be set to 1
 * when using following features:
 * EDF scheduling policy, Timing-Error-Detection of execution time,
@@ -74,10 +241,31 @@ extern "C" {
 	#define schedSCHEDULER_PRIORITY ( configMAX_PRIORITIES - 1 )
 	/* Stack size of the scheduler task. */
 	#define schedSCHEDULER_TASK_STACK_SIZE 1000 
-	/* The period of the scheduler task in software ticks. */
-	#define schedSCHEDULER_TASK_PERIOD pdMS_TO_TICKS( 50 )	
+	/* The scheduler task is woken by the tick hook exactly at the next
+	 * deadline or unblock time of any task. This is the longest it sleeps
+	 * without such an event, in software ticks. */
+	#define schedSCHEDULER_TASK_PERIOD pdMS_TO_TICKS( 1000 )	
 #endif /* schedUSE_SCHEDULER_TASK */
 
+/* Highest priority given to periodic tasks and servers. The scheduler
+ * priority is shared with the background service if it steals slack. */
+#if( schedUSE_APERIODIC_JOBS == 1 && schedUSE_BACKGROUND_SERVICE == 1 && schedUSE_SLACK_STEALING == 1 )
+	#define schedHIGHEST_TASK_PRIORITY ( schedSCHEDULER_PRIORITY - 1 )
+#elif( schedUSE_SCHEDULER_TASK == 1 )
+	#define schedHIGHEST_TASK_PRIORITY schedSCHEDULER_PRIORITY
+#else
+	#define schedHIGHEST_TASK_PRIORITY configMAX_PRIORITIES
+#endif /* schedUSE_SLACK_STEALING */
+
+/* Distance between the fixed priorities of consecutive tasks. Preemption
+ * thresholds take the free level between two tasks, so configMAX_PRIORITIES
+ * should offer about two levels per task. Tasks beyond share the lowest. */
+#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+	#define schedPRIORITY_STRIDE 2
+#else
+	#define schedPRIORITY_STRIDE 1
+#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+
 #if( schedUSE_POLLING_SERVER == 1 )
 	/* The period of the Polling Server. */
 	#define schedPOLLING_SERVER_PERIOD pdMS_TO_TICKS( 1000 )
@@ -90,8 +278,76 @@ extern "C" {
 	#define schedPOLLING_SERVER_STACK_SIZE 2000
 	/* Execution budget of the Polling Server. */
 	#define schedPOLLING_SERVER_MAX_EXECUTION_TIME pdMS_TO_TICKS( 450 )
+	/* Maximum number of servers, including server 0 that vSchedulerInit
+	 * creates with the parameters above. Further servers are created with
+	 * xSchedulerServerCreate. Every server takes a periodic task slot and,
+	 * with schedUSE_APERIODIC_WORKER_TASK, its own worker task. */
+	#define schedMAX_NUMBER_OF_SERVERS 1
+	/* Set this define to 1 to run the Polling Server as a Deferrable Server.
+	 * Budget left unused when the queue is empty is kept for the rest of the
+	 * period and aperiodic jobs are served as soon as they are released. */
+	#define schedUSE_DEFERRABLE_SERVER 0
+	/* Set this define to 1 to run the Polling Server as a Sporadic Server.
+	 * Jobs are served as soon as they are released and every chunk of consumed
+	 * budget is replenished one server period after the server became active.
+	 * Requires Timing-Error-Detection of execution time. */
+	#define schedUSE_SPORADIC_SERVER 0
+	#if( schedUSE_SPORADIC_SERVER == 1 )
+		/* Maximum number of pending budget replenishments. When the list is
+		 * full, a new chunk is merged into the latest replenishment. */
+		#define schedSPORADIC_SERVER_MAX_REPLENISHMENTS 4
+	#endif /* schedUSE_SPORADIC_SERVER */
+	/* Set this define to 1 to run the Polling Server as a Total Bandwidth
+	 * Server. Requires the EDF scheduling policy and a single server. Every
+	 * job gets the deadline max( release time, previous deadline ) +
+	 * WCET / Us and the server is
+	 * scheduled by that deadline alongside the periodic tasks. A job that
+	 * exceeds its WCET is blocked until its deadline, which is then postponed
+	 * by WCET / Us (CBS rule), so periodic tasks stay isolated. */
+	#define schedUSE_TOTAL_BANDWIDTH_SERVER 0
+	#if( schedUSE_TOTAL_BANDWIDTH_SERVER == 1 )
+		/* Server bandwidth Us in percent of the CPU. */
+		#define schedTOTAL_BANDWIDTH_SERVER_UTILIZATION 20
+	#endif /* schedUSE_TOTAL_BANDWIDTH_SERVER */
 #endif /* schedUSE_POLLING_SERVER */
 
+/* Scheduler events, as recorded in the trace and passed to schedTRACE_EVENT_HOOK. */
+#define schedTRACE_EVENT_START		0	/* A periodic job started. */
+#define schedTRACE_EVENT_END		1	/* A periodic job finished. */
+#define schedTRACE_EVENT_MISS		2	/* A deadline was missed. */
+#define schedTRACE_EVENT_OVERRUN	3	/* The worst-case execution time was exceeded. */
+#define schedTRACE_EVENT_SUSPEND	4	/* The task was suspended until its next period. */
+#define schedTRACE_EVENT_RESUME		5	/* The task was resumed. */
+#define schedTRACE_EVENT_ABORT		6	/* The server aborted an aperiodic job. */
+
+/* Set this define to 1 to enable modes. A mode is a subset of the periodic
+ * tasks with their own periods, WCETs and deadlines, and its own Polling
+ * Server parameters. The scheduler starts in mode 0 and switches to another
+ * mode on request, see xSchedulerModeChange. Requires the scheduler task. */
+#define schedUSE_MODES 0
+
+#if( schedUSE_MODES == 1 )
+	/* Number of modes, including mode 0. */
+	#define schedMAX_NUMBER_OF_MODES 2
+#endif /* schedUSE_MODES */
+
+/* Set this define to 1 to enable shared resources, e.g. a bus used by
+ * several periodic tasks. The users of a resource and their longest critical
+ * sections are declared before vSchedulerStart, and every resource gets the
+ * highest priority of its users as ceiling. A task that takes a resource runs
+ * at its ceiling until it gives it back (immediate priority ceiling), so no
+ * other user runs meanwhile. FreeRTOS time slices tasks of equal priority, so
+ * jobs released at the ceiling yield until the resource is free. Critical
+ * sections must not block. A job waits at most for one critical section of
+ * a lower priority task and only before it starts, which the response time
+ * analysis adds as blocking. Requires RMS or DMS. */
+#define schedUSE_RESOURCES 0
+
+#if( schedUSE_RESOURCES == 1 )
+	/* Number of resources, at most 8. */
+	#define schedMAX_NUMBER_OF_RESOURCES 2
+#endif /* schedUSE_RESOURCES */
+
 /* This function must be called before any other function call from scheduler.h. */
 void vSchedulerInit( void );
 
@@ -103,20 +359,262 @@ void vSchedulerInit( void );
  * pvParameters: Parameters to the task function.
  * uxPriority: Priority of the task. (Only used when scheduling policy is set to manual)
  * pxCreatedTask: Pointer to the task handle.
- * xPhaseTick: Phase given in software ticks. Counted from when vSchedulerStart is called.
+ * xPhaseTick: Phase given in software ticks. Counted from when vSchedulerStart is called, or
+ *   from now for a task created while the scheduler runs.
  * xPeriodTick: Period given in software ticks.
  * xMaxExecTimeTick: Worst-case execution time given in software ticks.
  * xDeadlineTick: Relative deadline given in software ticks.
+ * uxMissPolicy: One of schedMISS_POLICY_*. Ignored without schedUSE_TIMING_ERROR_DETECTION_DEADLINE.
+ *
+ * May be called from a task after vSchedulerStart. RMS and DMS priorities of
+ * the running tasks are updated, and *pxCreatedTask is valid on return.
+ * Returns pdFAIL and creates nothing if no TCB is free, or, once the
+ * scheduler runs, no stack. *pxCreatedTask is NULL then. Stacks of tasks
+ * created before vSchedulerStart are only allocated there.
  * */
-void vSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
-		TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick );
+BaseType_t xSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, void *pvParameters, UBaseType_t uxPriority,
+		TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick,
+		UBaseType_t uxMissPolicy );
+
+#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+	/* Creates a periodic task like xSchedulerPeriodicTaskCreate, but only if
+	 * all periodic tasks still meet their deadlines with the new one, as
+	 * decided by exact response time analysis under the configured fixed
+	 * priority policy. May be called before or after vSchedulerStart.
+	 *
+	 * pxResponseTime: Set to the worst-case response time of the new task in
+	 * software ticks, or portMAX_DELAY if it was rejected. May be NULL.
+	 * Returns pdFAIL and creates nothing if the task set would become
+	 * unschedulable.
+	 * */
+	BaseType_t xSchedulerPeriodicTaskAdmit( TaskFunction_t pvTaskCode, const char *pcName, configSTACK_DEPTH_TYPE usStackDepth, void *pvParameters, UBaseType_t uxPriority,
+			TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick,
+			UBaseType_t uxMissPolicy, TickType_t *pxResponseTime );
+
+	/* Returns the worst-case response time of a periodic task in software
+	 * ticks, computed whenever the task set changes, or portMAX_DELAY if the
+	 * task can miss its deadline. The response time of the scheduler task is
+	 * not included. */
+	TickType_t xSchedulerPeriodicTaskResponseTime( TaskHandle_t xTaskHandle );
 
-/* Deletes a periodic task associated with the given task handle. */
+	#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+		/* Returns the preemption threshold of a periodic task or server. */
+		UBaseType_t uxSchedulerGetPreemptionThreshold( TaskHandle_t xTaskHandle );
+
+		/* Returns the stack in words that the periodic tasks and servers can
+		 * occupy at the same time: the configured stacks of the deepest chain
+		 * of tasks that can preempt one another. FreeRTOS keeps a stack per
+		 * task, this is what a single stack shared by them would need. */
+		uint32_t ulSchedulerGetSharedStackDepth( void );
+	#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+
+#if( schedUSE_TASK_TABLE == 1 )
+	/* A periodic task of a task table, with the parameters of
+	 * xSchedulerPeriodicTaskCreate. pvParameters and pxCreatedTask must be
+	 * addresses of static objects. */
+	typedef struct xSchedTaskSpec
+	{
+		TaskFunction_t pvTaskCode;
+		const char *pcName;
+		configSTACK_DEPTH_TYPE usStackDepth;
+		void *pvParameters;
+		TaskHandle_t *pxCreatedTask;
+		TickType_t xPhaseTick;
+		TickType_t xPeriodTick;
+		TickType_t xMaxExecTimeTick;
+		TickType_t xDeadlineTick;
+		UBaseType_t uxMissPolicy;
+	} SchedTaskSpec_t;
+
+	/* A task of a task table with the priority and worst-case response time
+	 * the compiler has computed. The Polling Server has a row with
+	 * pvTaskCode set to NULL. */
+	typedef struct xSchedTaskTableEntry
+	{
+		SchedTaskSpec_t xSpec;
+		UBaseType_t uxPriority;
+		TickType_t xResponseTime;	/* portMAX_DELAY if the deadline can be missed. */
+	} SchedTaskTableEntry_t;
+
+	/* Creates the tasks of a task table, given in priority order. Use
+	 * vSchedulerTaskTableCreate instead. */
+	void vSchedulerTaskTableCreateEntries( const SchedTaskTableEntry_t *pxEntries, UBaseType_t uxCount );
+#endif /* schedUSE_TASK_TABLE */
+
+/* Deletes a periodic task associated with the given task handle. May be
+ * called while the scheduler runs, also by the task itself unless
+ * schedUSE_STATIC_ALLOCATION is enabled. The Polling Server cannot be
+ * deleted. */
 void vSchedulerPeriodicTaskDelete( TaskHandle_t xTaskHandle );
 
 /* Starts scheduling tasks. */
 void vSchedulerStart( void );
 
+#if( schedUSE_MODES == 1 )
+	/* Creates mode uxMode with the given name. Mode 0 exists from the start
+	 * and is renamed by this call. Every periodic task takes part in every
+	 * mode with the parameters it was created with, until it is changed with
+	 * vSchedulerModeSetTask. */
+	void vSchedulerModeCreate( UBaseType_t uxMode, const char *pcName );
+
+	/* Sets period, WCET and relative deadline of a periodic task in mode
+	 * uxMode, in software ticks. The task is identified by the pointer to its
+	 * handle passed on creation, since tasks outside the current mode have no
+	 * handle. A period of 0 leaves the task out of the mode. The current mode
+	 * can only be changed before vSchedulerStart. */
+	void vSchedulerModeSetTask( UBaseType_t uxMode, TaskHandle_t *pxCreatedTask, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick,
+			TickType_t xDeadlineTick );
+
+	#if( schedUSE_POLLING_SERVER == 1 )
+		/* Sets the parameters of server uxServer in mode uxMode, in software
+		 * ticks. Servers take part in every mode. */
+		void vSchedulerModeSetServer( UBaseType_t uxMode, UBaseType_t uxServer, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick,
+				TickType_t xDeadlineTick );
+	#endif /* schedUSE_POLLING_SERVER */
+
+	/* Requests a change to mode uxMode. Before vSchedulerStart this selects
+	 * the mode to start in.
+	 *
+	 * The change takes place at the next idle instant of the periodic tasks:
+	 * jobs in progress complete, no new job is started, and once none is left
+	 * the scheduler task deletes the tasks of the old mode and releases all
+	 * tasks of the new mode at the same tick, with their phases, as
+	 * vSchedulerStart does. Old jobs only lose interference, so they keep
+	 * their deadlines, and the new mode starts at the critical instant its
+	 * own analysis assumes. Tasks that are part of both modes skip the
+	 * releases in between. Queued aperiodic jobs are kept; a job the server
+	 * runs completes first. Jobs that overrun or miss their deadline delay
+	 * the change.
+	 *
+	 * Returns pdFAIL if the mode was not created or another change is pending.
+	 * */
+	BaseType_t xSchedulerModeChange( UBaseType_t uxMode );
+
+	/* Returns the current mode. A requested mode becomes current once the
+	 * change has taken place. */
+	UBaseType_t uxSchedulerGetMode( void );
+
+	/* Returns the name of mode uxMode, or NULL if it was not created. */
+	const char *pcSchedulerGetModeName( UBaseType_t uxMode );
+
+	#if( schedUSE_RESPONSE_TIME_ANALYSIS == 1 )
+		/* Returns the longest time in software ticks a mode change requested
+		 * now can take, the largest response time of the current mode, or
+		 * portMAX_DELAY if a task can miss its deadline. A job the server
+		 * runs at the request is not included. */
+		TickType_t xSchedulerModeChangeLatency( void );
+	#endif /* schedUSE_RESPONSE_TIME_ANALYSIS */
+#endif /* schedUSE_MODES */
+
+#if( schedUSE_RESOURCES == 1 )
+	/* Creates a resource. Must be called before vSchedulerStart. Returns the
+	 * number of the resource, or -1 if schedMAX_NUMBER_OF_RESOURCES is
+	 * reached. */
+	BaseType_t xSchedulerResourceCreate( const char *pcName );
+
+	/* Declares that the periodic task created with the handle pointer
+	 * pxCreatedTask takes resource uxResource for at most
+	 * xCriticalSectionTick software ticks at a time. Must be called before
+	 * vSchedulerStart. Task tables are analysed by the compiler without
+	 * blocking, vSchedulerStart repeats the analysis with it. */
+	void vSchedulerResourceUse( UBaseType_t uxResource, TaskHandle_t *pxCreatedTask, TickType_t xCriticalSectionTick );
+
+	/* Takes a resource in a job of a declared user. Never blocks, the free
+	 * resource is guaranteed by the ceiling. Resources may be nested. */
+	void vSchedulerResourceTake( UBaseType_t uxResource );
+
+	/* Gives back a resource taken by the calling task. Tasks kept out by the
+	 * ceiling run now if they have a higher priority. An overrun detected
+	 * during the critical section suspends the task here. */
+	void vSchedulerResourceGive( UBaseType_t uxResource );
+
+	/* Returns the ceiling priority of a resource. */
+	UBaseType_t uxSchedulerGetResourceCeiling( UBaseType_t uxResource );
+#endif /* schedUSE_RESOURCES */
+
+#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+	/* Charge execution time at context switches. Called by the kernel through
+	 * traceTASK_SWITCHED_IN and traceTASK_SWITCHED_OUT with interrupts
+	 * disabled. */
+	void vSchedulerTaskSwitchedIn( void );
+	void vSchedulerTaskSwitchedOut( void );
+#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+
+#if( schedUSE_TRACE_BUFFER == 1 )
+	/* Returns the number of trace records dropped because the trace buffer was
+	 * full. The counter is never reset; a growing value means the drain task
+	 * cannot keep up and schedTRACE_BUFFER_LENGTH should be increased. */
+	UBaseType_t uxSchedulerGetTraceOverflowCount( void );
+#endif /* schedUSE_TRACE_BUFFER */
+
+#if( schedUSE_TASK_STATISTICS == 1 )
+	/* Timing statistics since vSchedulerStart. Execution times are given in
+	 * software ticks, or in microseconds with schedUSE_PRECISE_EXECUTION_TIME.
+	 * All other times are given in software ticks and measured from the
+	 * release of a job. */
+	typedef struct xSchedTaskStats
+	{
+		uint32_t ulJobCount;			/* Number of completed jobs. */
+		TickType_t xMinExecTime;		/* portMAX_DELAY while ulJobCount is 0. */
+		TickType_t xMaxExecTime;
+		TickType_t xMeanExecTime;
+		TickType_t xMinResponseTime;	/* portMAX_DELAY while ulJobCount is 0. */
+		TickType_t xMaxResponseTime;
+		TickType_t xMeanResponseTime;
+		TickType_t xMaxReleaseJitter;	/* Longest time from release to start. */
+		uint32_t ulDeadlineMissCount;
+		uint32_t ulOverrunCount;		/* Worst-case execution time exceeded, or aperiodic job aborted. */
+		/* Bucket i counts response times from i to i + 1 bucket widths, the
+		 * last bucket all longer ones. */
+		uint32_t ulResponseTimeHistogram[ schedSTATS_HISTOGRAM_BUCKETS ];
+	} SchedTaskStats_t;
+
+	/* Copies the statistics of a periodic task to pxStats. Returns pdFAIL if
+	 * the task was not created by this library. */
+	BaseType_t xSchedulerGetTaskStats( TaskHandle_t xTaskHandle, SchedTaskStats_t *pxStats );
+
+	#if( schedUSE_POLLING_SERVER == 1 )
+		/* Copies the statistics of server uxServer to pxStats. A job of the
+		 * server lasts from its release until it runs out of work, so its
+		 * execution time is the budget it used. A Deferrable Server whose
+		 * budget is exhausted continues its job in the next period. A job of
+		 * the Sporadic Server is a chunk, from the time it starts to consume
+		 * budget until it runs out of work or budget. The Total Bandwidth
+		 * Server never completes a job and only counts overruns. */
+		void vSchedulerGetServerStats( UBaseType_t uxServer, SchedTaskStats_t *pxStats );
+	#endif /* schedUSE_POLLING_SERVER */
+
+	#if( schedUSE_APERIODIC_JOBS == 1 )
+		/* Copies the statistics of all aperiodic jobs together to pxStats.
+		 * Aborted jobs count as completed. Deadlines are only known to the
+		 * Total Bandwidth Server. */
+		void vSchedulerGetAperiodicStats( SchedTaskStats_t *pxStats );
+	#endif /* schedUSE_APERIODIC_JOBS */
+#endif /* schedUSE_TASK_STATISTICS */
+
+#if( schedUSE_STACK_PROFILING == 1 )
+	/* Stack use of a task, sizes in words. */
+	typedef struct xSchedStackUsage
+	{
+		const char *pcName;
+		configSTACK_DEPTH_TYPE usStackDepth;		/* Stack size the task was created with. */
+		configSTACK_DEPTH_TYPE usMaxUsed;			/* Deepest use seen, also across recreations of the task. */
+		configSTACK_DEPTH_TYPE usRecommendedDepth;	/* usMaxUsed plus the safety margin. */
+	} SchedStackUsage_t;
+
+	/* Fills pxUsage for the task with the given index and returns pdPASS, or
+	 * returns pdFAIL if there is no such task. Periodic tasks and the servers
+	 * come first, then the scheduler task, the trace drain task, the
+	 * background service and the aperiodic worker of every server, as far as
+	 * they are enabled. Scans the stacks, so
+	 * it takes time proportional to their size. */
+	BaseType_t xSchedulerGetStackUsage( UBaseType_t uxIndex, SchedStackUsage_t *pxUsage );
+
+	/* Prints the stack use of all tasks over Serial. */
+	void vSchedulerPrintStackReport( void );
+#endif /* schedUSE_STACK_PROFILING */
+
 #if ( schedUSE_APERIODIC_JOBS == 1 )
 	/* Creates an aperiodic job.
 	 *
@@ -124,13 +622,266 @@ void vSchedulerStart( void );
 	 * pcName: Name of the job.
 	 * pvParameters: Parameters to the job function.
 	 * xMaxExecTimeTick: Worst-case execution time given in software ticks.
+	 * xPhaseTick: Release time given in software ticks.
 	 * */
 	void vSchedulerAperiodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters, TickType_t xMaxExecTimeTick, TickType_t xPhaseTick );
+
+	/* Creates an aperiodic job like vSchedulerAperiodicTaskCreate.
+	 *
+	 * Jobs are served in order of release time. uxPriority orders jobs
+	 * released at the same tick, higher values are served first.
+	 * */
+	void vSchedulerAperiodicTaskCreatePriority( TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters, TickType_t xMaxExecTimeTick, TickType_t xPhaseTick,
+			UBaseType_t uxPriority );
+
+	/* Submits an aperiodic job from an interrupt handler. The job is released
+	 * at the current tick. Interrupts are never disabled: the job goes to a
+	 * single-producer/single-consumer ring that the server empties, so
+	 * submitting interrupt handlers must not nest.
+	 *
+	 * pxHigherPriorityTaskWoken: Set to pdTRUE if the server was woken and a
+	 * context switch should be requested before leaving the interrupt.
+	 * Returns pdFAIL if the ring is full.
+	 * */
+	BaseType_t xSchedulerAperiodicJobSubmitFromISR( TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters, TickType_t xMaxExecTimeTick,
+			BaseType_t *pxHigherPriorityTaskWoken );
+
+	/* Creates a server with its own queue of aperiodic jobs. Must be called
+	 * before vSchedulerStart. Under RMS and DMS the server gets its priority
+	 * from xPeriodTick or xDeadlineTick like a periodic task, so a server
+	 * with a short period serves its jobs before those of other servers.
+	 *
+	 * pcName: Name of the server task.
+	 * xPeriodTick: Period given in software ticks.
+	 * xMaxExecTimeTick: Budget per period given in software ticks.
+	 * xDeadlineTick: Relative deadline given in software ticks.
+	 *
+	 * Returns the number of the server, which selects it when jobs are
+	 * created, or -1 if schedMAX_NUMBER_OF_SERVERS or
+	 * schedMAX_NUMBER_OF_PERIODIC_TASKS is reached. Server 0 always exists.
+	 * */
+	BaseType_t xSchedulerServerCreate( const char *pcName, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick );
+
+	/* Creates an aperiodic job like vSchedulerAperiodicTaskCreatePriority,
+	 * served by server uxServer. The other functions use server 0. Every
+	 * server queues up to schedMAX_NUMBER_OF_APERIODIC_JOBS jobs. */
+	void vSchedulerAperiodicTaskCreateOnServer( UBaseType_t uxServer, TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters,
+			TickType_t xMaxExecTimeTick, TickType_t xPhaseTick, UBaseType_t uxPriority );
+
+	/* Submits an aperiodic job like xSchedulerAperiodicJobSubmitFromISR, to
+	 * server uxServer. Every server has its own ring. */
+	BaseType_t xSchedulerAperiodicJobSubmitToServerFromISR( UBaseType_t uxServer, TaskFunction_t pvTaskCode, const char *pcName, void *pvParameters,
+			TickType_t xMaxExecTimeTick, BaseType_t *pxHigherPriorityTaskWoken );
 #endif /* schedUSE_APERIODIC_JOBS */
 
 #ifdef __cplusplus
 }
 #endif
 
+#if( defined( __cplusplus ) && schedUSE_TASK_TABLE == 1 )
+	/* Task tables declare the periodic task set at compile time:
+	 *
+	 *   static constexpr SchedTaskSpec_t xSpecs[] = {
+	 *       { vTask1, "T1", 128, NULL, &xHandle1, 0, 124, 27, 124, schedMISS_POLICY_ABORT_JOB },
+	 *       ...
+	 *   };
+	 *   static constexpr auto xTable = xSchedulerTaskTableBuild( xSpecs );
+	 *   static_assert( xSchedulerTaskTableIsSchedulable( xTable ), "task set is not schedulable" );
+	 *
+	 *   vSchedulerInit();
+	 *   vSchedulerTaskTableCreate( xTable );
+	 *   vSchedulerStart();
+	 *
+	 * The compiler assigns the priorities of prvSetFixedPriorities and runs
+	 * the response time analysis of scheduler.cpp, including the Polling
+	 * Server. If no other periodic task is created before vSchedulerStart,
+	 * both are skipped at start, the analysis only runs again for slack
+	 * stealing. sim/tasktable.cpp checks that both copies agree. Needs
+	 * C++11. */
+
+	#if( schedUSE_POLLING_SERVER == 1 )
+		#define schedTASK_TABLE_SERVER_ROWS 1
+	#else
+		#define schedTASK_TABLE_SERVER_ROWS 0
+	#endif /* schedUSE_POLLING_SERVER */
+
+	/* Tasks of a task table in priority order, the highest first. */
+	template< size_t N >
+	struct SchedTaskTable
+	{
+		SchedTaskTableEntry_t xEntries[ N + schedTASK_TABLE_SERVER_ROWS ];
+	};
+
+	template< size_t... I >
+	struct SchedIndexList
+	{
+	};
+
+	/* SchedIndexList< 0, 1, ..., N - 1 >. */
+	template< size_t N, size_t... I >
+	struct SchedMakeIndexList : SchedMakeIndexList< N - 1, N - 1, I... >
+	{
+	};
+
+	template< size_t... I >
+	struct SchedMakeIndexList< 0, I... >
+	{
+		typedef SchedIndexList< I... > Type;
+	};
+
+	/* The functions below are evaluated by the compiler. C++11 allows only a
+	 * single return statement, so loops are written as recursion. Row v of a
+	 * task set is the Polling Server for v < schedTASK_TABLE_SERVER_ROWS and
+	 * a task of xSpecs otherwise, in the order vSchedulerInit and
+	 * vSchedulerTaskTableCreate add them. */
+
+	#if( schedUSE_POLLING_SERVER == 1 )
+		constexpr SchedTaskSpec_t prvTaskTableServerRow()
+		{
+			return SchedTaskSpec_t{ NULL, "PS", schedPOLLING_SERVER_STACK_SIZE, NULL, NULL, 0, schedPOLLING_SERVER_PERIOD,
+					schedPOLLING_SERVER_MAX_EXECUTION_TIME, schedPOLLING_SERVER_DEADLINE, schedMISS_POLICY_ABORT_JOB };
+		}
+
+		template< size_t N >
+		constexpr SchedTaskSpec_t prvTaskTableRow( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v )
+		{
+			return ( v < schedTASK_TABLE_SERVER_ROWS ) ? prvTaskTableServerRow() : xSpecs[ v - schedTASK_TABLE_SERVER_ROWS ];
+		}
+	#else
+		template< size_t N >
+		constexpr SchedTaskSpec_t prvTaskTableRow( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v )
+		{
+			return xSpecs[ v ];
+		}
+	#endif /* schedUSE_POLLING_SERVER */
+
+	/* Release jitter of row v, see prvInterference. */
+	#if( schedUSE_POLLING_SERVER == 1 && schedUSE_DEFERRABLE_SERVER == 1 )
+		constexpr TickType_t prvTaskTableJitter( size_t v )
+		{
+			return ( v < schedTASK_TABLE_SERVER_ROWS ) ? schedPOLLING_SERVER_PERIOD - schedPOLLING_SERVER_MAX_EXECUTION_TIME : 0;
+		}
+	#else
+		constexpr TickType_t prvTaskTableJitter( size_t )
+		{
+			return 0;
+		}
+	#endif /* schedUSE_DEFERRABLE_SERVER */
+
+	/* The parameter that orders the priorities. */
+	constexpr TickType_t prvTaskTableKey( const SchedTaskSpec_t &xSpec )
+	{
+		#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS )
+			return xSpec.xPeriodTick;
+		#else
+			return xSpec.xDeadlineTick;
+		#endif /* schedSCHEDULING_POLICY */
+	}
+
+	/* Number of rows from u on that get a higher priority than row v. Rows
+	 * of equal key keep their order, like prvAddTCBToArray. */
+	template< size_t N >
+	constexpr size_t prvTaskTableRank( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v, size_t u = 0 )
+	{
+		return ( N + schedTASK_TABLE_SERVER_ROWS == u ) ? 0 :
+				( ( prvTaskTableKey( prvTaskTableRow( xSpecs, u ) ) < prvTaskTableKey( prvTaskTableRow( xSpecs, v ) ) ||
+				( prvTaskTableKey( prvTaskTableRow( xSpecs, u ) ) == prvTaskTableKey( prvTaskTableRow( xSpecs, v ) ) && u < v ) ) ? 1 : 0 ) +
+				prvTaskTableRank( xSpecs, v, u + 1 );
+	}
+
+	/* Priority of row v, as assigned by prvSetFixedPriorities. */
+	template< size_t N >
+	constexpr UBaseType_t prvTaskTablePriority( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v )
+	{
+		return ( prvTaskTableRank( xSpecs, v ) * schedPRIORITY_STRIDE < schedHIGHEST_TASK_PRIORITY - schedLOWEST_TASK_PRIORITY ) ?
+				schedHIGHEST_TASK_PRIORITY - prvTaskTableRank( xSpecs, v ) * schedPRIORITY_STRIDE : schedLOWEST_TASK_PRIORITY;
+	}
+
+	/* Demand of the rows from u on with higher or equal priority than row v
+	 * within xWindow ticks, see prvInterference. */
+	template< size_t N >
+	constexpr TickType_t prvTaskTableInterference( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v, TickType_t xWindow, size_t u = 0 )
+	{
+		return ( N + schedTASK_TABLE_SERVER_ROWS == u ) ? 0 :
+				( ( u == v || prvTaskTablePriority( xSpecs, u ) < prvTaskTablePriority( xSpecs, v ) ) ? 0 :
+				( xWindow + prvTaskTableJitter( u ) + prvTaskTableRow( xSpecs, u ).xPeriodTick - 1 ) / prvTaskTableRow( xSpecs, u ).xPeriodTick *
+				prvTaskTableRow( xSpecs, u ).xMaxExecTimeTick ) + prvTaskTableInterference( xSpecs, v, xWindow, u + 1 );
+	}
+
+	/* Fixed point iteration for job q of row v from xBusyPeriod on. Returns
+	 * the end of the busy period, or portMAX_DELAY once the job can miss its
+	 * deadline. */
+	template< size_t N >
+	constexpr TickType_t prvTaskTableBusyPeriod( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v, TickType_t q, TickType_t xBusyPeriod )
+	{
+		return ( xBusyPeriod - q * prvTaskTableRow( xSpecs, v ).xPeriodTick > prvTaskTableRow( xSpecs, v ).xDeadlineTick ) ? portMAX_DELAY :
+				( ( q + 1 ) * prvTaskTableRow( xSpecs, v ).xMaxExecTimeTick + prvTaskTableInterference( xSpecs, v, xBusyPeriod ) == xBusyPeriod ) ? xBusyPeriod :
+				prvTaskTableBusyPeriod( xSpecs, v, q, ( q + 1 ) * prvTaskTableRow( xSpecs, v ).xMaxExecTimeTick + prvTaskTableInterference( xSpecs, v, xBusyPeriod ) );
+	}
+
+	constexpr TickType_t prvTaskTableMax( TickType_t xA, TickType_t xB )
+	{
+		return ( xA > xB ) ? xA : xB;
+	}
+
+	/* Checks the jobs of row v in the level-i busy period from job q on,
+	 * which ends at xBusyPeriod, see prvResponseTime. */
+	template< size_t N >
+	constexpr TickType_t prvTaskTableResponseTime( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v, TickType_t q, TickType_t xBusyPeriod,
+			TickType_t xResponseTime )
+	{
+		return ( portMAX_DELAY == xBusyPeriod ) ? portMAX_DELAY :
+				( xBusyPeriod <= ( q + 1 ) * prvTaskTableRow( xSpecs, v ).xPeriodTick ) ?
+				prvTaskTableMax( xResponseTime, xBusyPeriod - q * prvTaskTableRow( xSpecs, v ).xPeriodTick ) :
+				prvTaskTableResponseTime( xSpecs, v, q + 1,
+						prvTaskTableBusyPeriod( xSpecs, v, q + 1, xBusyPeriod + prvTaskTableRow( xSpecs, v ).xMaxExecTimeTick ),
+						prvTaskTableMax( xResponseTime, xBusyPeriod - q * prvTaskTableRow( xSpecs, v ).xPeriodTick ) );
+	}
+
+	/* Row of the given rank. */
+	template< size_t N >
+	constexpr size_t prvTaskTableRowOfRank( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t uxRank, size_t v = 0 )
+	{
+		return ( prvTaskTableRank( xSpecs, v ) == uxRank ) ? v : prvTaskTableRowOfRank( xSpecs, uxRank, v + 1 );
+	}
+
+	template< size_t N >
+	constexpr SchedTaskTableEntry_t prvTaskTableEntry( const SchedTaskSpec_t ( &xSpecs )[ N ], size_t v )
+	{
+		return SchedTaskTableEntry_t{ prvTaskTableRow( xSpecs, v ), prvTaskTablePriority( xSpecs, v ),
+				prvTaskTableResponseTime( xSpecs, v, 0, prvTaskTableBusyPeriod( xSpecs, v, 0, prvTaskTableRow( xSpecs, v ).xMaxExecTimeTick ), 0 ) };
+	}
+
+	template< size_t N, size_t... I >
+	constexpr SchedTaskTable< N > prvTaskTableBuild( const SchedTaskSpec_t ( &xSpecs )[ N ], SchedIndexList< I... > )
+	{
+		return SchedTaskTable< N >{ { prvTaskTableEntry( xSpecs, prvTaskTableRowOfRank( xSpecs, I ) )... } };
+	}
+
+	/* Returns the task table of the given task set. */
+	template< size_t N >
+	constexpr SchedTaskTable< N > xSchedulerTaskTableBuild( const SchedTaskSpec_t ( &xSpecs )[ N ] )
+	{
+		return prvTaskTableBuild( xSpecs, typename SchedMakeIndexList< N + schedTASK_TABLE_SERVER_ROWS >::Type() );
+	}
+
+	/* Returns true if no task of the table, including the Polling Server,
+	 * can miss its deadline. */
+	template< size_t N >
+	constexpr bool xSchedulerTaskTableIsSchedulable( const SchedTaskTable< N > &xTable, size_t uxIndex = 0 )
+	{
+		return ( N + schedTASK_TABLE_SERVER_ROWS == uxIndex ) ||
+				( xTable.xEntries[ uxIndex ].xResponseTime != portMAX_DELAY && xSchedulerTaskTableIsSchedulable( xTable, uxIndex + 1 ) );
+	}
+
+	/* Creates the periodic tasks of a task table. Must be called after
+	 * vSchedulerInit and before vSchedulerStart. */
+	template< size_t N >
+	inline void vSchedulerTaskTableCreate( const SchedTaskTable< N > &xTable )
+	{
+		vSchedulerTaskTableCreateEntries( xTable.xEntries, N + schedTASK_TABLE_SERVER_ROWS );
+	}
+#endif /* __cplusplus && schedUSE_TASK_TABLE */
+
 
 #endif /* SCHEDULER_H_ */
@@ -0,0 +1,29 @@
+#ifndef SIM_ARDUINO_H_
+#define SIM_ARDUINO_H_
+
+/* Host replacement of the Arduino core: only Serial, see vSimulatorSetSerialEcho. */
+
+#include "Arduino_FreeRTOS.h"
+
+#ifdef __cplusplus
+
+class SimSerial
+{
+public:
+	void begin( unsigned long ulBaud ) { ( void ) ulBaud; }
+	void flush( void );
+	void print( const char *pcText );
+	void print( char cValue );
+	template< typename T > void print( T xValue ) { prvPrintNumber( ( long long ) xValue ); }
+	void println( void ) { print( "\n" ); }
+	template< typename T > void println( T xValue ) { print( xValue ); println(); }
+
+private:
+	void prvPrintNumber( long long llValue );
+};
+
+extern SimSerial Serial;
+
+#endif /* __cplusplus */
+
+#endif /* SIM_ARDUINO_H_ */
@@ -0,0 +1,151 @@
+#ifndef SIM_ARDUINO_FREERTOS_H_
+#define SIM_ARDUINO_FREERTOS_H_
+
+/* Host replacement of Arduino_FreeRTOS for the scheduler simulator. Only the
+ * kernel API used by scheduler.cpp is provided. Types and tick rate follow
+ * the ATmega2560 port so that task sets keep their timing on the host. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* The ATmega2560 port can also be built with 16 bit ticks. */
+#define configUSE_16_BIT_TICKS		0
+
+typedef int8_t BaseType_t;
+typedef uint8_t UBaseType_t;
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+#else
+	typedef uint32_t TickType_t;
+#endif
+typedef uint8_t StackType_t;
+typedef void ( *TaskFunction_t )( void * );
+typedef void *TaskHandle_t;
+
+/* Task control block storage for xTaskCreateStatic. The simulator keeps its
+ * own task state, so the buffer is only required to exist. */
+typedef struct xSTATIC_TCB
+{
+	void *pvDummy[ 4 ];
+} StaticTask_t;
+
+#define pdFALSE						( ( BaseType_t ) 0 )
+#define pdTRUE						( ( BaseType_t ) 1 )
+#define pdFAIL						( pdFALSE )
+#define pdPASS						( pdTRUE )
+#if( configUSE_16_BIT_TICKS == 1 )
+	#define portMAX_DELAY			( ( TickType_t ) 0xffff )
+#else
+	#define portMAX_DELAY			( ( TickType_t ) 0xffffffffUL )
+#endif
+
+#define configTICK_RATE_HZ			( ( TickType_t ) 62 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define pdMS_TO_TICKS( xTimeInMs )	( ( TickType_t ) ( ( ( TickType_t ) ( xTimeInMs ) * configTICK_RATE_HZ ) / ( TickType_t ) 1000U ) )
+
+#define configMAX_PRIORITIES		4
+#define configMINIMAL_STACK_SIZE	192
+#define configMAX_TASK_NAME_LEN		8
+#define configSTACK_DEPTH_TYPE		uint16_t
+#define configUSE_TICK_HOOK			1
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_uxTaskGetStackHighWaterMark2 1
+#define tskIDLE_PRIORITY			( ( UBaseType_t ) 0 )
+
+/* Only one simulated task runs at a time and the tick hook never interrupts
+ * a task, so critical sections need no protection. */
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskENTER_CRITICAL_FROM_ISR()	0
+#define taskEXIT_CRITICAL_FROM_ISR( x )	( ( void ) ( x ) )
+#define portYIELD_FROM_ISR( x )			( ( void ) ( x ) )
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define configASSERT( x ) if( !( x ) ) vSimulatorAssert( __FILE__, __LINE__ )
+
+/* Scheduler events are reported to the simulator as they happen. */
+#define schedTRACE_EVENT_HOOK( ucEvent, pcName, xTick ) vSimulatorTraceEvent( ( ucEvent ), ( pcName ), ( xTick ) )
+
+/* Execution times are measured on simulated time. */
+#define schedCLOCK_US() ulSimulatorClockUs()
+
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char *pcName, uint16_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask );
+TaskHandle_t xTaskCreateStatic( TaskFunction_t pxTaskCode, const char *pcName, uint32_t ulStackDepth, void *pvParameters, UBaseType_t uxPriority,
+		StackType_t *puxStackBuffer, StaticTask_t *pxTaskBuffer );
+void vTaskDelete( TaskHandle_t xTaskToDelete );
+void vTaskDelay( TickType_t xTicksToDelay );
+BaseType_t xTaskDelayUntil( TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement );
+void vTaskSuspend( TaskHandle_t xTaskToSuspend );
+void vTaskResume( TaskHandle_t xTaskToResume );
+BaseType_t xTaskResumeFromISR( TaskHandle_t xTaskToResume );
+UBaseType_t uxTaskPriorityGet( TaskHandle_t xTask );
+UBaseType_t uxTaskPriorityGetFromISR( TaskHandle_t xTask );
+void vTaskPrioritySet( TaskHandle_t xTask, UBaseType_t uxNewPriority );
+void vPortYield( void );
+#define taskYIELD() vPortYield()
+TickType_t xTaskGetTickCount( void );
+TickType_t xTaskGetTickCountFromISR( void );
+TaskHandle_t xTaskGetCurrentTaskHandle( void );
+TaskHandle_t xTaskGetIdleTaskHandle( void );
+char *pcTaskGetName( TaskHandle_t xTaskToQuery );
+configSTACK_DEPTH_TYPE uxTaskGetStackHighWaterMark2( TaskHandle_t xTask );
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify );
+void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken );
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait );
+void vTaskSetThreadLocalStoragePointer( TaskHandle_t xTaskToSet, BaseType_t xIndex, void *pvValue );
+void *pvTaskGetThreadLocalStoragePointer( TaskHandle_t xTaskToQuery, BaseType_t xIndex );
+void vTaskSuspendAll( void );
+BaseType_t xTaskResumeAll( void );
+
+/* Runs the simulation until the horizon set with vSimulatorSetHorizon, then
+ * returns, unlike the real kernel. */
+void vTaskStartScheduler( void );
+
+/* Called every tick by the simulated kernel. */
+void vApplicationTickHook( void );
+
+/* Consumes xTicks ticks of simulated CPU time in the calling task. The task
+ * can be preempted and suspended meanwhile, exactly like a busy loop. */
+void vSimulatorExecute( TickType_t xTicks );
+
+/* Returns the simulated time in microseconds. It does not wrap with the
+ * tick count. */
+uint32_t ulSimulatorClockUs( void );
+
+/* Returns the number of context switches so far, and in *pulPreemptions how
+ * many of them left a task that was still ready. */
+uint32_t ulSimulatorContextSwitches( uint32_t *pulPreemptions );
+
+/* Returns the mean host time of a call of the tick hook in nanoseconds,
+ * timer reads included. Unlike everything else it varies from run to run. */
+uint32_t ulSimulatorTickHookNs( void );
+
+/* Returns how often the code of the existing task pcName was resumed, and in
+ * *pulHostUs the host time it ran in microseconds, which varies from run to
+ * run. Names compare up to configMAX_TASK_NAME_LEN - 1 characters. Returns 0
+ * for an unknown task. */
+uint32_t ulSimulatorTaskActivations( const char *pcName, uint32_t *pulHostUs );
+
+/* Sets the number of ticks after which vTaskStartScheduler returns. It can
+ * exceed the range of TickType_t, so that the tick count wraps. */
+void vSimulatorSetHorizon( uint32_t ulTicks );
+
+/* Prints Serial output to stderr if xEcho is pdTRUE, drops it otherwise. */
+void vSimulatorSetSerialEcho( BaseType_t xEcho );
+
+/* Receives every scheduler event, implemented by the simulator front end. */
+void vSimulatorTraceEvent( uint8_t ucEvent, const char *pcName, TickType_t xTick );
+
+/* Reports a failed configASSERT and terminates. */
+void vSimulatorAssert( const char *pcFile, int iLine );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_ARDUINO_FREERTOS_H_ */
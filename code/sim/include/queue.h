@@ -0,0 +1,2 @@
+/* Part of the simulator kernel API, see Arduino_FreeRTOS.h. */
+#include "Arduino_FreeRTOS.h"
@@ -0,0 +1,387 @@
+#!/bin/bash
+# Runs the simulator scenarios and checks their expected results.
+#
+# Usage: scenarios/check.sh [scenario...]
+#
+# Without arguments every scenario runs. A scenario builds the simulator with
+# its own scheduler configuration, runs task sets of this directory and
+# compares the summaries. Each DEFINE=VALUE given to build replaces the first
+# definition of DEFINE in a copy of scheduler.h or Arduino_FreeRTOS.h, the
+# sources themselves stay untouched. Builds use -Wall and a new warning
+# fails like a check. Exits with 1 if any check fails.
+
+SIM=$( cd "$( dirname "$0" )/.." && pwd )
+SCENARIOS="$SIM/scenarios"
+WORK=$( mktemp -d )
+trap 'rm -rf "$WORK"' EXIT
+FAILURES=0
+
+# prepare NAME [DEFINE=VALUE...] copies the sources to $WORK/NAME and sets
+# the defines, so a scenario can still change the copy before compile.
+prepare()
+{
+	local xDir="$WORK/$1"
+	shift
+	mkdir -p "$xDir/sim"
+	cp "$SIM/../scheduler.h" "$SIM/../scheduler.cpp" "$xDir"
+	cp -r "$SIM/include" "$SIM"/*.cpp "$xDir/sim"
+	for xDefine in "$@"; do
+		local xName=${xDefine%%=*}
+		local xValue=${xDefine#*=}
+		local xFile=
+		for xCandidate in "$xDir/scheduler.h" "$xDir/sim/include/Arduino_FreeRTOS.h"; do
+			if grep -q "#define $xName[[:space:]]" "$xCandidate"; then
+				xFile=$xCandidate
+				break
+			fi
+		done
+		if [ -z "$xFile" ]; then
+			echo "unknown define $xName" >&2
+			exit 2
+		fi
+		sed -i "0,/^\([[:space:]]*#define $xName\)[[:space:]].*/s//\1 $xValue/" "$xFile"
+	done
+}
+
+# Warnings the sources had before the checks started. Any other warning
+# fails the scenario that built it.
+BASELINE_WARNINGS="'void prvSchedulerFunction()' declared 'static' but never defined"
+
+# compile_program NAME PROGRAM SOURCE... compiles sources of $WORK/NAME/sim
+# into $WORK/NAME/PROGRAM and counts new warnings as failures.
+compile_program()
+{
+	local xDir="$WORK/$1"
+	local xProgram=$2
+	shift 2
+	( cd "$xDir/sim" && g++ -std=gnu++11 -O2 -Wall -Iinclude -I.. "$@" -o "../$xProgram" ) 2> "$xDir/$xProgram.log" || { cat "$xDir/$xProgram.log" >&2; exit 2; }
+	local xWarnings=$( grep 'warning:' "$xDir/$xProgram.log" | grep -vF "$BASELINE_WARNINGS" )
+	if [ -n "$xWarnings" ]; then
+		echo "$xWarnings" | sed 's/^/  FAIL  /'
+		FAILURES=$(( FAILURES + 1 ))
+	fi
+}
+
+# compile NAME creates $WORK/NAME/schedsim.
+compile()
+{
+	compile_program "$1" schedsim simkernel.cpp simmain.cpp ../scheduler.cpp
+}
+
+# build NAME [DEFINE=VALUE...] prepares and compiles.
+build()
+{
+	prepare "$@"
+	compile "$1"
+}
+
+# run NAME OUTPUT [schedsim arguments...] writes events to OUTPUT.csv and the
+# summary to OUTPUT.txt.
+run()
+{
+	local xSim="$WORK/$1/schedsim"
+	local xOutput="$WORK/$2"
+	shift 2
+	if ! "$xSim" "$@" > "$xOutput.csv" 2> "$xOutput.txt"; then
+		echo "  FAIL  $( tail -n 1 "$xOutput.txt" )"
+		FAILURES=$(( FAILURES + 1 ))
+	fi
+}
+
+# misses OUTPUT prints the number of deadline misses of a run.
+misses()
+{
+	sed -n 's/^\([0-9]*\) deadline misses$/\1/p' "$WORK/$1.txt"
+}
+
+# response OUTPUT TASKSET prints the mean and the 99th percentile of the
+# response times of the aperiodic jobs, from their A line to their end.
+response()
+{
+	awk -F '[ ,]' '
+		FNR == NR { if( $1 == "A" ) xRelease[ $2 ] = $3; next }
+		$3 == "end" && ( $2 in xRelease ) { print $1 - xRelease[ $2 ] }' "$2" "$WORK/$1.csv" | sort -n |
+		awk '{ xTimes[ NR ] = $1; xSum += $1 }
+			END { if( NR == 0 ) print "0 0"; else printf "%d %d\n", xSum / NR, xTimes[ int( ( 99 * NR + 99 ) / 100 ) ] }'
+}
+
+# late OUTPUT TASKSET prints the aperiodic jobs that did not start in the
+# first instance of the server "PS" that starts at or after their release.
+late()
+{
+	awk -F '[ ,]' '
+		FNR == NR { if( $1 == "A" ) xRelease[ $2 ] = $3; next }
+		$2 == "PS" && $3 == "start" { xStarts[ ++n ] = $1; xOpen = $1 }
+		( $2 in xRelease ) && $3 == "start" { xServedBy[ $2 ] = xOpen }
+		END {
+			for( xJob in xRelease ) {
+				xFirst = -1
+				for( i = 1; i <= n && xFirst < 0; i++ ) if( xStarts[ i ] >= xRelease[ xJob ] ) xFirst = xStarts[ i ]
+				if( !( xJob in xServedBy ) || xServedBy[ xJob ] != xFirst ) print xJob
+			}
+		}' "$2" "$WORK/$1.csv"
+}
+
+# latency OUTPUT TASKSET prints the number of deadline misses and their
+# mean and largest detection latency in ticks, from the missed deadline to
+# the miss event.
+latency()
+{
+	awk -F '[ ,]' '
+		FNR == NR { if( $1 == "P" ) { xPhase[ $2 ] = $4; xPeriod[ $2 ] = $5; xDeadline[ $2 ] = $6 } next }
+		$3 == "miss" && ( $2 in xPeriod ) {
+			k = int( ( $1 - 1 - xPhase[ $2 ] - xDeadline[ $2 ] ) / xPeriod[ $2 ] )
+			xLatency = $1 - ( xPhase[ $2 ] + k * xPeriod[ $2 ] + xDeadline[ $2 ] )
+			n++; xSum += xLatency
+			if( xLatency > xMax ) xMax = xLatency
+		}
+		END { printf "%d %.1f %d\n", n, ( n > 0 ) ? xSum / n : 0, xMax }' "$2" "$WORK/$1.csv"
+}
+
+# check DESCRIPTION CONDITION... evaluates an arithmetic condition.
+check()
+{
+	local xDescription=$1
+	shift
+	if (( $* )); then
+		echo "  ok    $xDescription"
+	else
+		echo "  FAIL  $xDescription"
+		FAILURES=$(( FAILURES + 1 ))
+	fi
+}
+
+# The thread local storage lookup keeps the tick hook independent of the
+# size of the task array. Best of five runs against host noise.
+scenario_tick_hook()
+{
+	local xBest=()
+	for xMax in 4 16 64; do
+		build "hook$xMax" schedMAX_NUMBER_OF_PERIODIC_TASKS=$xMax
+		local xNs=
+		for xRun in 1 2 3 4 5; do
+			run "hook$xMax" "hook$xMax" -b -t 223200 "$SIM/taskset.txt"
+			local xThis=$( sed -n 's/^\([0-9]*\) ns per tick hook on the host$/\1/p' "$WORK/hook$xMax.txt" )
+			if [ -z "$xNs" ] || (( xThis < xNs )); then
+				xNs=$xThis
+			fi
+		done
+		echo "  schedMAX_NUMBER_OF_PERIODIC_TASKS $xMax: $xNs ns per tick hook"
+		xBest+=( "$xNs" )
+	done
+	check "tick hook cost flat from 4 to 64 tasks" "${xBest[2]} < 2 * ${xBest[0]} + 10"
+}
+
+# On the ProjectF task set T2 misses its first deadline under RMS, which
+# favours T1 for its shorter period although T2 has the shorter deadline.
+scenario_edf()
+{
+	build rms
+	build edf schedSCHEDULING_POLICY=schedSCHEDULING_POLICY_EDF
+	run rms rms -t 223200 "$SIM/taskset.txt"
+	run edf edf -t 223200 "$SIM/taskset.txt"
+	echo "  RMS $( misses rms ) misses, EDF $( misses edf ) misses"
+	check "RMS misses a deadline" "$( misses rms ) > 0"
+	check "EDF meets every deadline" "$( misses edf ) == 0"
+}
+
+# The Deferrable Server keeps its budget for jobs that arrive after the
+# start of its period, the Polling Server gives it up.
+scenario_deferrable()
+{
+	build polling schedMAX_NUMBER_OF_APERIODIC_JOBS=100
+	build deferrable schedMAX_NUMBER_OF_APERIODIC_JOBS=100 schedUSE_DEFERRABLE_SERVER=1
+	run polling polling -t 223200 "$SCENARIOS/aperiodic.txt"
+	run deferrable deferrable -t 223200 "$SCENARIOS/aperiodic.txt"
+	local xPolling=( $( response polling "$SCENARIOS/aperiodic.txt" ) )
+	local xDeferrable=( $( response deferrable "$SCENARIOS/aperiodic.txt" ) )
+	echo "  polling    mean ${xPolling[0]} p99 ${xPolling[1]} ticks, $( misses polling ) misses"
+	echo "  deferrable mean ${xDeferrable[0]} p99 ${xDeferrable[1]} ticks, $( misses deferrable ) misses"
+	check "deferrable mean response below half of polling" "2 * ${xDeferrable[0]} < ${xPolling[0]}"
+	check "deferrable p99 response below polling" "${xDeferrable[1]} < ${xPolling[1]}"
+	check "deferrable misses no more periodic deadlines" "$( misses deferrable ) <= $( misses polling )"
+}
+
+# A Sporadic Server gives back budget one period after it was used, so under
+# an aperiodic overload it interferes with the periodic tasks no more than a
+# periodic task of its budget and period would.
+scenario_sporadic()
+{
+	build sporadic schedMAX_NUMBER_OF_APERIODIC_JOBS=100 schedUSE_SPORADIC_SERVER=1
+	run sporadic sporadic -v -t 20000 "$SCENARIOS/adversarial.txt"
+	local xChunks=$( awk '$1 == "server" { print $2 }' "$WORK/sporadic.txt" )
+	local xServed=$( grep -c ',A[0-9]*,end$' "$WORK/sporadic.csv" )
+	echo "  $( misses sporadic ) misses, $xServed of 100 aperiodic jobs served in $xChunks chunks"
+	check "response time analysis finds the task set schedulable" "$( grep -c 'not schedulable' "$WORK/sporadic.txt" ) == 0"
+	check "periodic tasks meet every deadline" "$( misses sporadic ) == 0"
+	check "every aperiodic job is served" "$xServed == 100"
+	check "server statistics count chunks" "$xChunks > 0"
+}
+
+# Jobs submitted out of release order must neither wait behind a job that
+# is not released yet nor start before their own release.
+scenario_out_of_order()
+{
+	build outoforder schedMAX_NUMBER_OF_APERIODIC_JOBS=16
+	run outoforder outoforder -t 75000 "$SCENARIOS/outoforder.txt"
+	local xLate=$( late outoforder "$SCENARIOS/outoforder.txt" )
+	echo "  jobs not started in the first server instance after their release: ${xLate:-none}"
+	check "every job starts in the first server instance after its release" "$( echo -n "$xLate" | wc -w ) == 0"
+}
+
+# The scheduler task wakes at the next timing event. The scan it replaced
+# is rebuilt by patching a copy: it wakes every 50 ms and checks every TCB.
+scenario_detection()
+{
+	build events schedMAX_NUMBER_OF_PERIODIC_TASKS=4
+	prepare scan schedMAX_NUMBER_OF_PERIODIC_TASKS=4 "schedSCHEDULER_TASK_PERIOD=pdMS_TO_TICKS( 50 )"
+	sed -i -e 's/xTaskGetTickCount() + ( xNextEventDelay > 0 ? xNextEventDelay : 1 )/xTaskGetTickCount() + schedSCHEDULER_TASK_PERIOD/' \
+		-e 's/if( 0 == xDelay )/if( pdTRUE )/' "$WORK/scan/scheduler.cpp"
+	compile scan
+	local xName xMisses=() xLatency=() xActivations=()
+	for xName in events scan; do
+		run "$xName" "$xName" -b -t 223200 "$SCENARIOS/misses.txt"
+		local xResult=( $( latency "$xName" "$SCENARIOS/misses.txt" ) )
+		local xCost=( $( sed -n 's/^\([0-9]*\) scheduler task activations, \([0-9]*\) us on the host$/\1 \2/p' "$WORK/$xName.txt" ) )
+		echo "  $xName: ${xResult[0]} misses, latency mean ${xResult[1]} max ${xResult[2]} ticks, ${xCost[0]} activations, ${xCost[1]} us"
+		xMisses+=( "${xResult[0]}" )
+		xLatency+=( "${xResult[2]}" )
+		xActivations+=( "${xCost[0]}" )
+	done
+	check "every miss detected one tick after the deadline" "${xMisses[0]} > 0 && ${xLatency[0]} == 1"
+	check "scan detects the same misses" "${xMisses[1]} == ${xMisses[0]}"
+	check "scan detects misses later" "${xLatency[1]} > ${xLatency[0]}"
+	check "fewer activations than the scan" "2 * ${xActivations[0]} < ${xActivations[1]}"
+}
+
+# Deleted tasks leave their stacks to the tasks created after them. The
+# pool holds the server and the stacks of T1 and T2 at their largest and
+# nothing more, so a stack lost on any cycle fails a later creation.
+scenario_stack_pool()
+{
+	build stackpool schedSTATIC_STACK_POOL_SIZE=3384
+	run stackpool stackpool -t 1000 "$SCENARIOS/stackpool.txt"
+	local xFailed=$( grep -c 'could not be created' "$WORK/stackpool.txt" )
+	local xJobs=$( awk -F , '$1 > 710 && $3 == "end" { n[ $2 ]++ } END { print n[ "T1" ] + 0, n[ "T2" ] + 0 }' "$WORK/stackpool.csv" )
+	echo "  $xFailed failed creations, T1 and T2 jobs after the last cycle: $xJobs"
+	check "every task is created again" "$xFailed == 0"
+	check "both tasks run after the last cycle" "$( echo $xJobs | tr ' ' '*' ) > 0"
+
+	# One word short, the larger stack of T2 never fits. Its creations fail
+	# and leave nothing behind, T1 keeps running.
+	build stackpool_short schedSTATIC_STACK_POOL_SIZE=3383
+	run stackpool_short stackpool_short -t 1000 "$SCENARIOS/stackpool.txt"
+	local xFailedShort=$( grep -c 'T2 could not be created' "$WORK/stackpool_short.txt" )
+	local xJobsShort=$( awk -F , '$1 > 710 && $3 == "end" { n[ $2 ]++ } END { print n[ "T1" ] + 0, n[ "T2" ] + 0 }' "$WORK/stackpool_short.csv" )
+	echo "  one word short: $xFailedShort failed creations of T2, T1 and T2 jobs after the last cycle: $xJobsShort"
+	check "failed creations return" "$xFailedShort == 7"
+	check "T1 runs without T2" "$( echo $xJobsShort | cut -d ' ' -f 1 ) > 0 && $( echo $xJobsShort | cut -d ' ' -f 2 ) == 0"
+}
+
+# Task tables repeat the priority assignment and the response time analysis
+# of scheduler.cpp in constexpr code. sim/tasktable.cpp compares both on
+# known task sets, in every configuration the analysis depends on.
+scenario_task_table()
+{
+	local xConfig
+	for xConfig in rms dms deferrable priorities; do
+		local xDefines=( schedMAX_NUMBER_OF_PERIODIC_TASKS=8 )
+		case $xConfig in
+			dms) xDefines+=( schedSCHEDULING_POLICY=schedSCHEDULING_POLICY_DMS ) ;;
+			deferrable) xDefines+=( schedUSE_DEFERRABLE_SERVER=1 ) ;;
+			priorities) xDefines+=( configMAX_PRIORITIES=8 ) ;;
+		esac
+		prepare "table_$xConfig" "${xDefines[@]}"
+		compile_program "table_$xConfig" tasktable simkernel.cpp tasktable.cpp ../scheduler.cpp
+		local xSet xDifferent=0
+		for xSet in projectf shared overload; do
+			if ! "$WORK/table_$xConfig/tasktable" "$xSet" > "$WORK/table_${xConfig}_$xSet.txt" 2>&1; then
+				sed -n 's/^\(.*\)  DIFFERENT$/  \1/p' "$WORK/table_${xConfig}_$xSet.txt"
+				xDifferent=$(( xDifferent + 1 ))
+			fi
+		done
+		check "$xConfig: task tables match the scheduler" "$xDifferent == 0"
+	done
+}
+
+# Slack stealing runs an aperiodic job at once while every task can still
+# absorb the delay, the Polling Server makes it wait for its next period.
+# ProjectF is only schedulable under DMS, and no slack is stolen otherwise.
+scenario_slack()
+{
+	local xDefines=( schedMAX_NUMBER_OF_APERIODIC_JOBS=100 schedSCHEDULING_POLICY=schedSCHEDULING_POLICY_DMS configMAX_PRIORITIES=8 )
+	build slack_polling "${xDefines[@]}"
+	build slack "${xDefines[@]}" schedUSE_BACKGROUND_SERVICE=1 schedUSE_SLACK_STEALING=1
+	run slack_polling slack_polling -t 223200 "$SCENARIOS/aperiodic.txt"
+	run slack slack -t 223200 "$SCENARIOS/aperiodic.txt"
+	local xPolling=( $( response slack_polling "$SCENARIOS/aperiodic.txt" ) )
+	local xSlack=( $( response slack "$SCENARIOS/aperiodic.txt" ) )
+	local xServed=$( grep -c ',A[0-9]*,end$' "$WORK/slack.csv" )
+	echo "  polling mean ${xPolling[0]} p99 ${xPolling[1]} ticks, $( misses slack_polling ) misses"
+	echo "  slack   mean ${xSlack[0]} p99 ${xSlack[1]} ticks, $( misses slack ) misses, $xServed of 100 jobs served"
+	check "every aperiodic job is served" "$xServed == 100"
+	check "slack stealing mean response below half of polling" "2 * ${xSlack[0]} < ${xPolling[0]}"
+	check "slack stealing p99 response below polling" "${xSlack[1]} < ${xPolling[1]}"
+	check "periodic tasks meet every deadline" "$( misses slack ) == 0"
+
+	# T1 leaves and comes back while jobs steal slack, so the tick hook
+	# walks the index around every change of it.
+	{ cat "$SCENARIOS/aperiodic.txt"; for xTick in 20000 60000 100000 140000 180000; do
+		echo "D T1 $xTick"; echo "E T1 $(( xTick + 3000 ))"; done; } > "$WORK/slack_changes_taskset.txt"
+	run slack slack_changes -t 223200 "$WORK/slack_changes_taskset.txt"
+	local xServedChanges=$( grep -c ',A[0-9]*,end$' "$WORK/slack_changes.csv" )
+	echo "  with T1 deleted and created again: $( misses slack_changes ) misses, $xServedChanges of 100 jobs served"
+	check "task set changes keep every job served" "$xServedChanges == 100"
+	check "task set changes keep every deadline" "$( misses slack_changes ) == 0"
+}
+
+# Tasks share resources at their ceiling priority. Every job meets its
+# deadline within the response time that includes its blocking, and the
+# aperiodic jobs take no resource. The shipped task set must run in this
+# configuration as well, its aperiodic jobs once took resource 0.
+scenario_resources()
+{
+	build resources schedUSE_RESOURCES=1 schedMAX_NUMBER_OF_PERIODIC_TASKS=8 schedPOLLING_SERVER_MAX_EXECUTION_TIME=4 configMAX_PRIORITIES=8
+	run resources resources -v -t 223200 "$SCENARIOS/resources.txt"
+	run resources resources_projectf -t 223200 "$SIM/taskset.txt"
+	local xTask xLate=0
+	for xTask in T1 T2 T3; do
+		local xWCRT=$( sed -n "s/^$xTask, .*WCRT- \([0-9]*\)$/\1/p" "$WORK/resources.txt" )
+		local xMax=$( awk -v xTask=$xTask '$1 == xTask && NF > 8 { print $8 }' "$WORK/resources.txt" )
+		echo "  $xTask: longest response $xMax ticks, WCRT ${xWCRT:-none}"
+		if [ -z "$xWCRT" ] || [ -z "$xMax" ] || (( xMax > xWCRT )); then
+			xLate=$(( xLate + 1 ))
+		fi
+	done
+	check "response time analysis finds the task set schedulable" "$( grep -c 'not schedulable' "$WORK/resources.txt" ) == 0"
+	check "periodic tasks meet every deadline" "$( misses resources ) == 0"
+	check "every response within its WCRT" "$xLate == 0"
+	check "aperiodic jobs are served" "$( grep -c ',A[0-9]*,end$' "$WORK/resources.csv" ) == 3"
+}
+
+# With 16 bit ticks the tick count wraps every 65536 ticks, three times in
+# this run. Every event must happen at the same tick modulo 65536 as with
+# 32 bit ticks, and the summaries must agree.
+scenario_tick_wrap()
+{
+	build wrap32 schedSCHEDULING_POLICY=schedSCHEDULING_POLICY_EDF
+	build wrap16 schedSCHEDULING_POLICY=schedSCHEDULING_POLICY_EDF configUSE_16_BIT_TICKS=1
+	run wrap32 wrap32 -t 223200 "$SIM/taskset.txt"
+	run wrap16 wrap16 -t 223200 "$SIM/taskset.txt"
+	local xDifferent=$( awk -F , -v OFS=, '{ $1 = $1 % 65536; print }' "$WORK/wrap32.csv" | diff - "$WORK/wrap16.csv" | grep -c '^[<>]' )
+	echo "  16 bit ticks: $( misses wrap16 ) misses, $xDifferent events differ from 32 bit ticks"
+	check "16 bit ticks meet every deadline" "$( misses wrap16 ) == 0"
+	check "16 bit ticks give the same events" "$xDifferent == 0"
+	check "16 bit ticks give the same summary" "$( diff "$WORK/wrap32.txt" "$WORK/wrap16.txt" | grep -c '^[<>]' ) == 0"
+}
+
+ALL="tick_hook edf deferrable sporadic out_of_order detection stack_pool task_table slack resources tick_wrap"
+for xScenario in ${*:-$ALL}; do
+	echo "$xScenario"
+	"scenario_$xScenario"
+done
+if (( FAILURES > 0 )); then
+	echo "$FAILURES checks failed"
+	exit 1
+fi
+echo "all checks passed"
@@ -0,0 +1,673 @@
+/* Discrete-event replacement of the FreeRTOS kernel for running scheduler.cpp
+ * on a host. Tasks are ucontext coroutines and exactly one of them runs at a
+ * time. Task code takes no simulated time except inside vSimulatorExecute, so
+ * time advances in whole ticks and a run depends on nothing but its input. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "scheduler.h"
+
+/* Installed in FreeRTOSConfig.h on the target. */
+#if( schedUSE_PRECISE_EXECUTION_TIME == 1 )
+	#define traceTASK_SWITCHED_IN() vSchedulerTaskSwitchedIn()
+	#define traceTASK_SWITCHED_OUT() vSchedulerTaskSwitchedOut()
+#else
+	#define traceTASK_SWITCHED_IN()
+	#define traceTASK_SWITCHED_OUT()
+#endif /* schedUSE_PRECISE_EXECUTION_TIME */
+
+/* Host bytes of stack given for every word of requested stack depth. Code,
+ * context switches and libc calls need far more stack on the host than on
+ * the ATmega2560, so stack figures of the simulator are host bytes divided
+ * by this factor and only approximate the target. */
+#define simSTACK_BYTES_PER_WORD 64
+/* Unused stack is filled with this value to find the high water mark. */
+#define simSTACK_FILL_BYTE 0xa5
+/* Bytes at the far end of a stack that must stay untouched. */
+#define simSTACK_GUARD_SIZE 16
+
+/* Signed difference of two tick counts, as in scheduler.cpp. */
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef int16_t SimTickDiff_t;
+#else
+	typedef int32_t SimTickDiff_t;
+#endif
+
+typedef enum
+{
+	eSimReady,
+	eSimBlocked,
+	eSimSuspended,
+	eSimDeleted
+} SimTaskState_t;
+
+typedef struct xSimTCB
+{
+	TaskFunction_t pxTaskCode;
+	void *pvParameters;
+	char pcName[ configMAX_TASK_NAME_LEN ];
+	UBaseType_t uxPriority;
+	SimTaskState_t eState;
+	uint32_t ulReadySequence;		/* Orders ready tasks of equal priority, lower runs first. */
+	uint32_t ulActivations;			/* Number of times the task code was resumed. */
+	uint64_t ullHostNs;				/* Host time spent in the task code. */
+	BaseType_t xDelayed;			/* pdTRUE if blocked with a timeout. */
+	TickType_t xWakeTime;			/* Tick at which a delayed task unblocks. */
+	BaseType_t xWaitingForNotification;
+	uint32_t ulNotifiedValue;
+	TickType_t xExecRemaining;		/* CPU time still to consume in vSimulatorExecute. */
+	void *pvThreadLocalStoragePointers[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
+	ucontext_t xContext;
+	void *pvStack;
+	size_t xStackSize;				/* Size of pvStack in bytes. */
+	struct xSimTCB *pxNext;			/* All existing tasks, in creation order. */
+} SimTCB_t;
+
+static SimTCB_t xIdleTCB;
+static SimTCB_t *pxTaskList = NULL;
+static SimTCB_t *pxCurrentTCB = &xIdleTCB;
+/* Task that ran last, it stays ahead of ready tasks of equal priority until
+ * its time slice ends. */
+static SimTCB_t *pxLastRunTCB = NULL;
+static ucontext_t xKernelContext;
+static BaseType_t xSchedulerRunning = pdFALSE;
+/* pdTRUE while not executing task code, i.e. during setup and the tick hook. */
+static BaseType_t xInKernel = pdTRUE;
+static TickType_t xTickCount = 0;
+/* Ticks since the start, unlike xTickCount they do not wrap at 16 bits. */
+static uint32_t ulElapsedTicks = 0;
+/* Switches from one task to another, the idle task included, and those of
+ * them away from a task that was still ready. */
+static uint32_t ulContextSwitches = 0;
+static uint32_t ulPreemptions = 0;
+/* Nesting depth of vTaskSuspendAll. Ticks only advance while task code
+ * executes or waits, so only preemption has to be held back. */
+static UBaseType_t uxSchedulerSuspended = 0;
+static uint32_t ulHorizon = UINT32_MAX;
+static uint32_t ulReadySequence = 0;
+static BaseType_t xSerialEcho = pdFALSE;
+/* Host time spent in the tick hook, only reported by benchmarks. */
+static uint64_t ullTickHookNs = 0;
+static uint32_t ulTickHookCalls = 0;
+
+SimSerial Serial;
+
+static SimTCB_t *prvGetTCB( TaskHandle_t xHandle )
+{
+	return ( xHandle != NULL ) ? ( SimTCB_t * ) xHandle : pxCurrentTCB;
+}
+
+static void prvMakeReady( SimTCB_t *pxTCB )
+{
+	pxTCB->eState = eSimReady;
+	pxTCB->xDelayed = pdFALSE;
+	pxTCB->ulReadySequence = ++ulReadySequence;
+}
+
+/* Returns a monotonic host clock in nanoseconds. */
+static uint64_t prvHostNs( void )
+{
+	struct timespec xNow;
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+
+/* Returns the task to run next, or NULL if the CPU would idle. */
+static SimTCB_t *prvSelectTask( void )
+{
+	SimTCB_t *pxBest = NULL;
+
+	for( SimTCB_t *pxTCB = pxTaskList; pxTCB != NULL; pxTCB = pxTCB->pxNext )
+	{
+		if( eSimReady != pxTCB->eState )
+		{
+			continue;
+		}
+		if( NULL == pxBest || pxTCB->uxPriority > pxBest->uxPriority )
+		{
+			pxBest = pxTCB;
+		}
+		else if( pxTCB->uxPriority == pxBest->uxPriority && pxBest != pxLastRunTCB &&
+				( pxTCB == pxLastRunTCB || pxTCB->ulReadySequence < pxBest->ulReadySequence ) )
+		{
+			pxBest = pxTCB;
+		}
+	}
+	return pxBest;
+}
+
+/* Hands control from the running task back to the kernel loop. */
+static void prvSwitchToKernel( void )
+{
+	configASSERT( pdFALSE == xInKernel );
+	swapcontext( &pxCurrentTCB->xContext, &xKernelContext );
+}
+
+/* Called by task code after a higher priority task may have become ready. */
+static void prvYieldIfPreempted( void )
+{
+	if( pdTRUE == xInKernel || pdFALSE == xSchedulerRunning || uxSchedulerSuspended > 0 )
+	{
+		return;
+	}
+	SimTCB_t *pxNext = prvSelectTask();
+	if( eSimReady != pxCurrentTCB->eState || ( pxNext != NULL && pxNext->uxPriority > pxCurrentTCB->uxPriority ) )
+	{
+		prvSwitchToKernel();
+	}
+}
+
+/* Blocks the running task for xTicksToWait ticks, forever for portMAX_DELAY. */
+static void prvBlockCurrentTask( TickType_t xTicksToWait )
+{
+	configASSERT( 0 == uxSchedulerSuspended );
+	pxCurrentTCB->eState = eSimBlocked;
+	pxCurrentTCB->xDelayed = ( xTicksToWait != portMAX_DELAY ) ? pdTRUE : pdFALSE;
+	pxCurrentTCB->xWakeTime = xTickCount + xTicksToWait;
+	prvSwitchToKernel();
+}
+
+static void prvTaskEntry( void )
+{
+	pxCurrentTCB->pxTaskCode( pxCurrentTCB->pvParameters );
+	/* FreeRTOS tasks must not return. */
+	vSimulatorAssert( __FILE__, __LINE__ );
+}
+
+/* Returns the number of bytes at the far end of the task's stack that were
+ * never written. */
+static size_t prvUnusedStack( const SimTCB_t *pxTCB )
+{
+	const uint8_t *pucStack = ( const uint8_t * ) pxTCB->pvStack;
+	size_t xUnused = 0;
+
+	while( xUnused < pxTCB->xStackSize && simSTACK_FILL_BYTE == pucStack[ xUnused ] )
+	{
+		xUnused++;
+	}
+	return xUnused;
+}
+
+/* Stops the simulation once a task has come close to the end of its stack,
+ * like configCHECK_FOR_STACK_OVERFLOW. */
+static void prvCheckStackGuard( const SimTCB_t *pxTCB )
+{
+	const uint8_t *pucStack = ( const uint8_t * ) pxTCB->pvStack;
+
+	for( size_t xIndex = 0; xIndex < simSTACK_GUARD_SIZE; xIndex++ )
+	{
+		if( pucStack[ xIndex ] != simSTACK_FILL_BYTE )
+		{
+			fprintf( stderr, "stack overflow in task %s\n", pxTCB->pcName );
+			exit( 1 );
+		}
+	}
+}
+
+/* Makes pxNext the running task, like vTaskSwitchContext. */
+static void prvSwitchContext( SimTCB_t *pxNext )
+{
+	if( pxNext != pxCurrentTCB )
+	{
+		ulContextSwitches++;
+		if( eSimReady == pxCurrentTCB->eState && pxCurrentTCB != &xIdleTCB )
+		{
+			ulPreemptions++;
+		}
+	}
+	traceTASK_SWITCHED_OUT();
+	pxCurrentTCB = pxNext;
+	traceTASK_SWITCHED_IN();
+}
+
+/* Frees deleted tasks. Only called on the kernel stack. */
+static void prvReapDeletedTasks( void )
+{
+	SimTCB_t **ppxLink = &pxTaskList;
+
+	while( *ppxLink != NULL )
+	{
+		SimTCB_t *pxTCB = *ppxLink;
+		if( eSimDeleted == pxTCB->eState )
+		{
+			*ppxLink = pxTCB->pxNext;
+			if( pxTCB == pxCurrentTCB )
+			{
+				pxCurrentTCB = &xIdleTCB;
+			}
+			if( pxTCB == pxLastRunTCB )
+			{
+				pxLastRunTCB = NULL;
+			}
+			free( pxTCB->pvStack );
+			free( pxTCB );
+		}
+		else
+		{
+			ppxLink = &pxTCB->pxNext;
+		}
+	}
+}
+
+/* Advances time by one tick, charged to pxCurrentTCB. */
+static void prvIncrementTick( void )
+{
+	if( pxCurrentTCB->xExecRemaining > 0 )
+	{
+		pxCurrentTCB->xExecRemaining--;
+	}
+
+	xTickCount++;
+	ulElapsedTicks++;
+	for( SimTCB_t *pxTCB = pxTaskList; pxTCB != NULL; pxTCB = pxTCB->pxNext )
+	{
+		if( eSimBlocked == pxTCB->eState && pdTRUE == pxTCB->xDelayed && ( SimTickDiff_t ) ( xTickCount - pxTCB->xWakeTime ) >= 0 )
+		{
+			pxTCB->xWaitingForNotification = pdFALSE;
+			prvMakeReady( pxTCB );
+		}
+	}
+
+	uint64_t ullStart = prvHostNs();
+	vApplicationTickHook();
+	ullTickHookNs += prvHostNs() - ullStart;
+	ulTickHookCalls++;
+
+	/* Time slicing among tasks of equal priority. */
+	if( pxCurrentTCB == pxLastRunTCB && eSimReady == pxCurrentTCB->eState )
+	{
+		pxCurrentTCB->ulReadySequence = ++ulReadySequence;
+		pxLastRunTCB = NULL;
+	}
+}
+
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char *pcName, uint16_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask )
+{
+	SimTCB_t *pxTCB = ( SimTCB_t * ) calloc( 1, sizeof( SimTCB_t ) );
+	configASSERT( pxTCB != NULL );
+	pxTCB->xStackSize = ( size_t ) usStackDepth * simSTACK_BYTES_PER_WORD;
+	pxTCB->pvStack = malloc( pxTCB->xStackSize );
+	configASSERT( pxTCB->pvStack != NULL );
+	memset( pxTCB->pvStack, simSTACK_FILL_BYTE, pxTCB->xStackSize );
+
+	pxTCB->pxTaskCode = pxTaskCode;
+	pxTCB->pvParameters = pvParameters;
+	strncpy( pxTCB->pcName, pcName, configMAX_TASK_NAME_LEN - 1 );
+	pxTCB->uxPriority = ( uxPriority < configMAX_PRIORITIES ) ? uxPriority : configMAX_PRIORITIES - 1;
+
+	getcontext( &pxTCB->xContext );
+	pxTCB->xContext.uc_stack.ss_sp = pxTCB->pvStack;
+	pxTCB->xContext.uc_stack.ss_size = pxTCB->xStackSize;
+	pxTCB->xContext.uc_link = NULL;
+	makecontext( &pxTCB->xContext, prvTaskEntry, 0 );
+
+	SimTCB_t **ppxLink = &pxTaskList;
+	while( *ppxLink != NULL )
+	{
+		ppxLink = &( *ppxLink )->pxNext;
+	}
+	*ppxLink = pxTCB;
+	prvMakeReady( pxTCB );
+
+	if( pxCreatedTask != NULL )
+	{
+		*pxCreatedTask = pxTCB;
+	}
+	prvYieldIfPreempted();
+	return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic( TaskFunction_t pxTaskCode, const char *pcName, uint32_t ulStackDepth, void *pvParameters, UBaseType_t uxPriority,
+		StackType_t *puxStackBuffer, StaticTask_t *pxTaskBuffer )
+{
+	TaskHandle_t xHandle = NULL;
+
+	configASSERT( puxStackBuffer != NULL && pxTaskBuffer != NULL );
+	xTaskCreate( pxTaskCode, pcName, ( uint16_t ) ulStackDepth, pvParameters, uxPriority, &xHandle );
+	return xHandle;
+}
+
+void vTaskDelete( TaskHandle_t xTaskToDelete )
+{
+	SimTCB_t *pxTCB = prvGetTCB( xTaskToDelete );
+
+	pxTCB->eState = eSimDeleted;
+	if( pxTCB == pxCurrentTCB && pdFALSE == xInKernel )
+	{
+		prvSwitchToKernel();
+	}
+}
+
+void vTaskDelay( TickType_t xTicksToDelay )
+{
+	if( xTicksToDelay > 0 )
+	{
+		prvBlockCurrentTask( xTicksToDelay );
+	}
+	else
+	{
+		pxCurrentTCB->ulReadySequence = ++ulReadySequence;
+		pxLastRunTCB = NULL;
+		prvSwitchToKernel();
+	}
+}
+
+BaseType_t xTaskDelayUntil( TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement )
+{
+	const TickType_t xConstTickCount = xTickCount;
+	TickType_t xTimeToWake = *pxPreviousWakeTime + xTimeIncrement;
+	BaseType_t xShouldDelay = pdFALSE;
+
+	/* Same overflow handling as tasks.c. */
+	if( xConstTickCount < *pxPreviousWakeTime )
+	{
+		if( xTimeToWake < *pxPreviousWakeTime && xTimeToWake > xConstTickCount )
+		{
+			xShouldDelay = pdTRUE;
+		}
+	}
+	else if( xTimeToWake < *pxPreviousWakeTime || xTimeToWake > xConstTickCount )
+	{
+		xShouldDelay = pdTRUE;
+	}
+
+	*pxPreviousWakeTime = xTimeToWake;
+	if( pdTRUE == xShouldDelay )
+	{
+		prvBlockCurrentTask( xTimeToWake - xConstTickCount );
+	}
+	return xShouldDelay;
+}
+
+void vTaskSuspend( TaskHandle_t xTaskToSuspend )
+{
+	SimTCB_t *pxTCB = prvGetTCB( xTaskToSuspend );
+
+	pxTCB->eState = eSimSuspended;
+	pxTCB->xDelayed = pdFALSE;
+	pxTCB->xWaitingForNotification = pdFALSE;
+	if( pxTCB == pxCurrentTCB && pdFALSE == xInKernel )
+	{
+		prvSwitchToKernel();
+	}
+}
+
+void vTaskResume( TaskHandle_t xTaskToResume )
+{
+	xTaskResumeFromISR( xTaskToResume );
+	prvYieldIfPreempted();
+}
+
+BaseType_t xTaskResumeFromISR( TaskHandle_t xTaskToResume )
+{
+	SimTCB_t *pxTCB = ( SimTCB_t * ) xTaskToResume;
+
+	configASSERT( pxTCB != NULL );
+	if( eSimSuspended != pxTCB->eState )
+	{
+		return pdFALSE;
+	}
+	prvMakeReady( pxTCB );
+	return ( pxTCB->uxPriority > pxCurrentTCB->uxPriority ) ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxTaskPriorityGet( TaskHandle_t xTask )
+{
+	return prvGetTCB( xTask )->uxPriority;
+}
+
+UBaseType_t uxTaskPriorityGetFromISR( TaskHandle_t xTask )
+{
+	return uxTaskPriorityGet( xTask );
+}
+
+void vTaskPrioritySet( TaskHandle_t xTask, UBaseType_t uxNewPriority )
+{
+	prvGetTCB( xTask )->uxPriority = ( uxNewPriority < configMAX_PRIORITIES ) ? uxNewPriority : configMAX_PRIORITIES - 1;
+	prvYieldIfPreempted();
+}
+
+/* The running task goes behind the ready tasks of its priority. */
+void vPortYield( void )
+{
+	if( pdTRUE == xInKernel || pdFALSE == xSchedulerRunning || uxSchedulerSuspended > 0 )
+	{
+		return;
+	}
+	pxCurrentTCB->ulReadySequence = ++ulReadySequence;
+	pxLastRunTCB = NULL;
+	prvSwitchToKernel();
+}
+
+TickType_t xTaskGetTickCount( void )
+{
+	return xTickCount;
+}
+
+TickType_t xTaskGetTickCountFromISR( void )
+{
+	return xTickCount;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+	return pxCurrentTCB;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandle( void )
+{
+	return &xIdleTCB;
+}
+
+configSTACK_DEPTH_TYPE uxTaskGetStackHighWaterMark2( TaskHandle_t xTask )
+{
+	return ( configSTACK_DEPTH_TYPE ) ( prvUnusedStack( prvGetTCB( xTask ) ) / simSTACK_BYTES_PER_WORD );
+}
+
+char *pcTaskGetName( TaskHandle_t xTaskToQuery )
+{
+	return prvGetTCB( xTaskToQuery )->pcName;
+}
+
+/* Increments the notification value, returns pdTRUE if the task was waiting
+ * for it and has a higher priority than the running task. */
+static BaseType_t prvNotifyGive( SimTCB_t *pxTCB )
+{
+	configASSERT( pxTCB != NULL );
+	pxTCB->ulNotifiedValue++;
+	if( eSimBlocked == pxTCB->eState && pdTRUE == pxTCB->xWaitingForNotification )
+	{
+		pxTCB->xWaitingForNotification = pdFALSE;
+		prvMakeReady( pxTCB );
+		return ( pxTCB->uxPriority > pxCurrentTCB->uxPriority ) ? pdTRUE : pdFALSE;
+	}
+	return pdFALSE;
+}
+
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify )
+{
+	prvNotifyGive( ( SimTCB_t * ) xTaskToNotify );
+	prvYieldIfPreempted();
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+{
+	if( pdTRUE == prvNotifyGive( ( SimTCB_t * ) xTaskToNotify ) && pxHigherPriorityTaskWoken != NULL )
+	{
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+}
+
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+{
+	if( 0 == pxCurrentTCB->ulNotifiedValue && xTicksToWait > 0 )
+	{
+		pxCurrentTCB->xWaitingForNotification = pdTRUE;
+		prvBlockCurrentTask( xTicksToWait );
+	}
+	pxCurrentTCB->xWaitingForNotification = pdFALSE;
+
+	uint32_t ulReturn = pxCurrentTCB->ulNotifiedValue;
+	if( ulReturn != 0 )
+	{
+		pxCurrentTCB->ulNotifiedValue = ( pdFALSE != xClearCountOnExit ) ? 0 : ulReturn - 1;
+	}
+	return ulReturn;
+}
+
+void vTaskSetThreadLocalStoragePointer( TaskHandle_t xTaskToSet, BaseType_t xIndex, void *pvValue )
+{
+	configASSERT( xIndex >= 0 && xIndex < configNUM_THREAD_LOCAL_STORAGE_POINTERS );
+	prvGetTCB( xTaskToSet )->pvThreadLocalStoragePointers[ xIndex ] = pvValue;
+}
+
+void *pvTaskGetThreadLocalStoragePointer( TaskHandle_t xTaskToQuery, BaseType_t xIndex )
+{
+	configASSERT( xIndex >= 0 && xIndex < configNUM_THREAD_LOCAL_STORAGE_POINTERS );
+	return prvGetTCB( xTaskToQuery )->pvThreadLocalStoragePointers[ xIndex ];
+}
+
+void vTaskSuspendAll( void )
+{
+	uxSchedulerSuspended++;
+}
+
+BaseType_t xTaskResumeAll( void )
+{
+	configASSERT( uxSchedulerSuspended > 0 );
+	uxSchedulerSuspended--;
+	prvYieldIfPreempted();
+	return pdFALSE;
+}
+
+void vTaskStartScheduler( void )
+{
+	strncpy( xIdleTCB.pcName, "IDLE", configMAX_TASK_NAME_LEN - 1 );
+	xIdleTCB.uxPriority = tskIDLE_PRIORITY;
+	xSchedulerRunning = pdTRUE;
+
+	while( ulElapsedTicks < ulHorizon )
+	{
+		SimTCB_t *pxNext = prvSelectTask();
+
+		if( NULL == pxNext )
+		{
+			prvSwitchContext( &xIdleTCB );
+			prvIncrementTick();
+		}
+		else if( pxNext->xExecRemaining > 0 )
+		{
+			/* The task is busy, it keeps the CPU for the whole tick. */
+			prvSwitchContext( pxNext );
+			pxLastRunTCB = pxNext;
+			prvIncrementTick();
+		}
+		else
+		{
+			prvSwitchContext( pxNext );
+			pxLastRunTCB = pxNext;
+			xInKernel = pdFALSE;
+			uint64_t ullStart = prvHostNs();
+			swapcontext( &xKernelContext, &pxNext->xContext );
+			pxNext->ullHostNs += prvHostNs() - ullStart;
+			pxNext->ulActivations++;
+			xInKernel = pdTRUE;
+			prvCheckStackGuard( pxNext );
+			prvReapDeletedTasks();
+		}
+	}
+	xSchedulerRunning = pdFALSE;
+}
+
+void vSimulatorExecute( TickType_t xTicks )
+{
+	if( xTicks > 0 )
+	{
+		pxCurrentTCB->xExecRemaining = xTicks;
+		prvSwitchToKernel();
+	}
+}
+
+uint32_t ulSimulatorClockUs( void )
+{
+	return ( uint32_t ) ( ( uint64_t ) ulElapsedTicks * 1000000U / configTICK_RATE_HZ );
+}
+
+uint32_t ulSimulatorContextSwitches( uint32_t *pulPreemptions )
+{
+	*pulPreemptions = ulPreemptions;
+	return ulContextSwitches;
+}
+
+uint32_t ulSimulatorTickHookNs( void )
+{
+	return ( ulTickHookCalls > 0 ) ? ( uint32_t ) ( ullTickHookNs / ulTickHookCalls ) : 0;
+}
+
+uint32_t ulSimulatorTaskActivations( const char *pcName, uint32_t *pulHostUs )
+{
+	for( SimTCB_t *pxTCB = pxTaskList; pxTCB != NULL; pxTCB = pxTCB->pxNext )
+	{
+		if( 0 == strncmp( pxTCB->pcName, pcName, configMAX_TASK_NAME_LEN - 1 ) )
+		{
+			*pulHostUs = ( uint32_t ) ( pxTCB->ullHostNs / 1000U );
+			return pxTCB->ulActivations;
+		}
+	}
+	*pulHostUs = 0;
+	return 0;
+}
+
+void vSimulatorSetHorizon( uint32_t ulTicks )
+{
+	ulHorizon = ulTicks;
+}
+
+void vSimulatorSetSerialEcho( BaseType_t xEcho )
+{
+	xSerialEcho = xEcho;
+}
+
+void vSimulatorAssert( const char *pcFile, int iLine )
+{
+	fflush( stdout );
+	fprintf( stderr, "assertion failed at %s:%d, tick %lu\n", pcFile, iLine, ( unsigned long ) xTickCount );
+	abort();
+}
+
+void SimSerial::flush( void )
+{
+	if( pdTRUE == xSerialEcho )
+	{
+		fflush( stderr );
+	}
+}
+
+void SimSerial::print( const char *pcText )
+{
+	if( pdTRUE == xSerialEcho )
+	{
+		fputs( pcText, stderr );
+	}
+}
+
+void SimSerial::print( char cValue )
+{
+	if( pdTRUE == xSerialEcho )
+	{
+		fputc( cValue, stderr );
+	}
+}
+
+void SimSerial::prvPrintNumber( long long llValue )
+{
+	if( pdTRUE == xSerialEcho )
+	{
+		fprintf( stderr, "%lld", llValue );
+	}
+}
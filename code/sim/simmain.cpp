@@ -0,0 +1,608 @@
+/* Command line front end of the scheduler simulator.
+ *
+ * Usage: schedsim [-s seed] [-t ticks] [-v] [-b] taskset
+ *
+ * Reads a task set, runs scheduler.cpp on the simulated kernel for the given
+ * number of ticks and prints one record per scheduler event to stdout as
+ * "tick,task,event". A summary per task goes to stderr. -v echoes the Serial
+ * output of the scheduler to stderr as well. -b adds host timings of the
+ * scheduler to the summary, the only part that differs between runs.
+ *
+ * Task set lines, times in ticks, '#' starts a comment:
+ *   P name priority phase period deadline wcet cmin cmax [abort|skip|continue]
+ *   V name period deadline wcet
+ *   A name release wcet cmin cmax [server]
+ *   D name tick
+ *   E name tick [stack]
+ *   M mode name
+ *   S mode name period deadline wcet
+ *   C mode tick
+ *   R name
+ *   U task resource offset length
+ * Every job executes for a time drawn uniformly from [cmin, cmax]; cmax above
+ * wcet makes jobs overrun. The last field of a periodic task selects its
+ * deadline miss policy, abort by default. D deletes a periodic task at the
+ * given tick and E creates it again, with its phase counted from that tick
+ * and, if given, a new stack depth in words.
+ * V creates a further server. An A line names the server of its job; the
+ * Polling Server that vSchedulerInit creates is called "server" and is the
+ * default. With schedUSE_MODES, M creates a mode, S sets the parameters of a
+ * task or server in a mode (period 0 leaves a task out) and C requests a
+ * change to the mode at the given tick. With schedUSE_RESOURCES, R creates a
+ * resource and U makes every job of a periodic task hold it for length ticks
+ * once it has executed for offset ticks, or for what is left of the job. A
+ * task created again by E holds no resource. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+
+#if( schedUSE_APERIODIC_JOBS == 1 )
+	#define simMAX_JOBS ( schedMAX_NUMBER_OF_PERIODIC_TASKS + schedMAX_NUMBER_OF_APERIODIC_JOBS )
+#else
+	#define simMAX_JOBS schedMAX_NUMBER_OF_PERIODIC_TASKS
+#endif /* schedUSE_APERIODIC_JOBS */
+
+/* A periodic task or aperiodic job read from the task set. */
+typedef struct xSimJob
+{
+	char pcName[ configMAX_TASK_NAME_LEN ];
+	TickType_t xMinExecTime;
+	TickType_t xMaxExecTime;
+	uint32_t ulEventCount[ schedTRACE_EVENT_ABORT + 1 ];
+
+	/* Parameters of a periodic task, kept to create it again. */
+	BaseType_t xIsPeriodic;
+	BaseType_t xEnabled;
+	TaskHandle_t xHandle;
+	UBaseType_t uxPriority;
+	UBaseType_t uxMissPolicy;
+	TickType_t xPhase;
+	TickType_t xPeriod;
+	TickType_t xDeadline;
+	TickType_t xWCET;
+	configSTACK_DEPTH_TYPE usStackDepth;
+	#if( schedUSE_RESOURCES == 1 )
+		BaseType_t xResource;	/* -1 if the job takes no resource. */
+		TickType_t xSectionOffset;
+		TickType_t xSectionLength;
+	#endif /* schedUSE_RESOURCES */
+} SimJob_t;
+
+/* A D, E or C line of the task set. */
+typedef struct xSimChange
+{
+	TickType_t xTick;
+	SimJob_t *pxJob;	/* NULL for a mode change. */
+	BaseType_t xEnable;
+	configSTACK_DEPTH_TYPE usStackDepth;	/* 0 keeps the stack depth of the task. */
+	UBaseType_t uxMode;
+} SimChange_t;
+
+#define simMAX_CHANGES 32
+/* Stack of the task that applies the changes, in words. */
+#define simCONTROL_STACK_SIZE 256
+
+static SimJob_t xJobs[ simMAX_JOBS ];
+static UBaseType_t uxJobCount = 0;
+static SimChange_t xChanges[ simMAX_CHANGES ];
+static UBaseType_t uxChangeCount = 0;
+#if( schedUSE_POLLING_SERVER == 1 )
+	/* Names of the servers, indexed by server number. */
+	static char pcServerNames[ schedMAX_NUMBER_OF_SERVERS ][ configMAX_TASK_NAME_LEN ] = { "server" };
+	static UBaseType_t uxServerCount = 1;
+#endif /* schedUSE_POLLING_SERVER */
+#if( schedUSE_RESOURCES == 1 )
+	/* Names of the resources, indexed by resource number. */
+	static char pcResourceNames[ schedMAX_NUMBER_OF_RESOURCES ][ configMAX_TASK_NAME_LEN ];
+	static UBaseType_t uxResourceCount = 0;
+#endif /* schedUSE_RESOURCES */
+static uint64_t ullRandomState;
+
+static const char * const pcEventNames[] = { "start", "end", "miss", "overrun", "suspend", "resume", "abort" };
+
+/* Indexed by schedMISS_POLICY_*. */
+static const char * const pcMissPolicyNames[] = { "abort", "skip", "continue" };
+
+/* xorshift64*, identical on every host for a given seed. */
+static uint32_t prvRandom( void )
+{
+	ullRandomState ^= ullRandomState >> 12;
+	ullRandomState ^= ullRandomState << 25;
+	ullRandomState ^= ullRandomState >> 27;
+	return ( uint32_t ) ( ( ullRandomState * 2685821657736338717ULL ) >> 32 );
+}
+
+/* Body of every simulated job. */
+static void prvSimulatedJob( void *pvParameters )
+{
+	SimJob_t *pxJob = ( SimJob_t * ) pvParameters;
+	TickType_t xRange = pxJob->xMaxExecTime - pxJob->xMinExecTime + 1;
+	TickType_t xExecTime = pxJob->xMinExecTime + prvRandom() % xRange;
+
+	#if( schedUSE_RESOURCES == 1 )
+		if( pxJob->xResource != -1 && xExecTime > pxJob->xSectionOffset )
+		{
+			TickType_t xSection = xExecTime - pxJob->xSectionOffset;
+			if( xSection > pxJob->xSectionLength )
+			{
+				xSection = pxJob->xSectionLength;
+			}
+			vSimulatorExecute( pxJob->xSectionOffset );
+			vSchedulerResourceTake( pxJob->xResource );
+			vSimulatorExecute( xSection );
+			vSchedulerResourceGive( pxJob->xResource );
+			xExecTime -= pxJob->xSectionOffset + xSection;
+		}
+	#endif /* schedUSE_RESOURCES */
+	vSimulatorExecute( xExecTime );
+}
+
+void vSimulatorTraceEvent( uint8_t ucEvent, const char *pcName, TickType_t xTick )
+{
+	configASSERT( ucEvent <= schedTRACE_EVENT_ABORT );
+	printf( "%lu,%s,%s\n", ( unsigned long ) xTick, pcName, pcEventNames[ ucEvent ] );
+
+	for( UBaseType_t uxIndex = 0; uxIndex < uxJobCount; uxIndex++ )
+	{
+		if( 0 == strcmp( xJobs[ uxIndex ].pcName, pcName ) )
+		{
+			xJobs[ uxIndex ].ulEventCount[ ucEvent ]++;
+		}
+	}
+}
+
+/* Creates the scheduler task of a periodic job. Returns pdFAIL if the
+ * scheduler has no TCB or stack left for it. */
+static BaseType_t prvEnablePeriodicJob( SimJob_t *pxJob )
+{
+	BaseType_t xReturn = xSchedulerPeriodicTaskCreate( prvSimulatedJob, pxJob->pcName, pxJob->usStackDepth, pxJob, pxJob->uxPriority,
+			&pxJob->xHandle, pxJob->xPhase, pxJob->xPeriod, pxJob->xWCET, pxJob->xDeadline, pxJob->uxMissPolicy );
+	pxJob->xEnabled = ( pdPASS == xReturn ) ? pdTRUE : pdFALSE;
+	return xReturn;
+}
+
+/* Applies the D and E lines while the scheduler runs, like an application
+ * task that switches parts of the task set on and off. */
+static void prvTaskSetControl( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for( UBaseType_t uxIndex = 0; uxIndex < uxChangeCount; uxIndex++ )
+	{
+		SimChange_t *pxChange = &xChanges[ uxIndex ];
+		TickType_t xNow = xTaskGetTickCount();
+
+		if( ( int32_t ) ( pxChange->xTick - xNow ) > 0 )
+		{
+			vTaskDelay( pxChange->xTick - xNow );
+		}
+		#if( schedUSE_MODES == 1 )
+			if( NULL == pxChange->pxJob )
+			{
+				BaseType_t xResult = xSchedulerModeChange( pxChange->uxMode );
+				fprintf( stderr, "%lu: change to mode %lu %s\n", ( unsigned long ) xTaskGetTickCount(), ( unsigned long ) pxChange->uxMode,
+						( pdPASS == xResult ) ? "requested" : "rejected" );
+				continue;
+			}
+		#endif /* schedUSE_MODES */
+		if( pdTRUE == pxChange->xEnable && pdFALSE == pxChange->pxJob->xEnabled )
+		{
+			#if( schedUSE_RESOURCES == 1 )
+				/* Users are declared before vSchedulerStart only. */
+				pxChange->pxJob->xResource = -1;
+			#endif /* schedUSE_RESOURCES */
+			if( pxChange->usStackDepth > 0 )
+			{
+				pxChange->pxJob->usStackDepth = pxChange->usStackDepth;
+			}
+			if( pdFAIL == prvEnablePeriodicJob( pxChange->pxJob ) )
+			{
+				fprintf( stderr, "%lu: %s could not be created\n", ( unsigned long ) xTaskGetTickCount(), pxChange->pxJob->pcName );
+			}
+		}
+		else if( pdFALSE == pxChange->xEnable && pdTRUE == pxChange->pxJob->xEnabled )
+		{
+			vSchedulerPeriodicTaskDelete( pxChange->pxJob->xHandle );
+			pxChange->pxJob->xEnabled = pdFALSE;
+		}
+	}
+	vTaskDelete( NULL );
+}
+
+/* Returns the periodic job with the given name, or NULL. */
+static SimJob_t *prvFindPeriodicJob( const char *pcName )
+{
+	for( UBaseType_t uxIndex = 0; uxIndex < uxJobCount; uxIndex++ )
+	{
+		if( pdTRUE == xJobs[ uxIndex ].xIsPeriodic && 0 == strcmp( xJobs[ uxIndex ].pcName, pcName ) )
+		{
+			return &xJobs[ uxIndex ];
+		}
+	}
+	return NULL;
+}
+
+#if( schedUSE_POLLING_SERVER == 1 )
+	/* Returns the number of the server with the given name, or -1. */
+	static BaseType_t prvFindServer( const char *pcName )
+	{
+		for( UBaseType_t uxIndex = 0; uxIndex < uxServerCount; uxIndex++ )
+		{
+			if( 0 == strcmp( pcServerNames[ uxIndex ], pcName ) )
+			{
+				return ( BaseType_t ) uxIndex;
+			}
+		}
+		return -1;
+	}
+#endif /* schedUSE_POLLING_SERVER */
+
+/* Reads the task set and creates its tasks and jobs. Returns pdFAIL on a
+ * malformed file. */
+static BaseType_t prvLoadTaskSet( const char *pcPath )
+{
+	FILE *pxFile = fopen( pcPath, "r" );
+	char pcLine[ 128 ];
+	unsigned long ulLine = 0;
+	UBaseType_t uxPeriodicCount = 0;
+
+	if( NULL == pxFile )
+	{
+		perror( pcPath );
+		return pdFAIL;
+	}
+
+	while( fgets( pcLine, sizeof( pcLine ), pxFile ) != NULL )
+	{
+		char cKind;
+		char pcPolicy[ 10 ] = "abort";
+		#if( schedUSE_APERIODIC_JOBS == 1 )
+			char pcServer[ configMAX_TASK_NAME_LEN ] = "server";
+		#endif /* schedUSE_APERIODIC_JOBS */
+		UBaseType_t uxPolicy = schedMISS_POLICY_ABORT_JOB;
+		unsigned long ulPriority, ulPhase, ulPeriod, ulDeadline, ulWCET, ulMin, ulMax;
+		SimJob_t *pxJob = &xJobs[ uxJobCount ];
+		BaseType_t xValid = pdFALSE;
+		#if( schedUSE_RESOURCES == 1 )
+			/* Only a U line gives a periodic task a resource. */
+			pxJob->xResource = -1;
+		#endif /* schedUSE_RESOURCES */
+
+		ulLine++;
+		char *pcComment = strchr( pcLine, '#' );
+		if( pcComment != NULL )
+		{
+			*pcComment = '\0';
+		}
+		if( sscanf( pcLine, " %c", &cKind ) != 1 )
+		{
+			continue;
+		}
+
+		#if( schedUSE_MODES == 1 )
+			char pcName[ configMAX_TASK_NAME_LEN ];
+			unsigned long ulMode, ulTick;
+			if( 'M' == cKind || 'S' == cKind || 'C' == cKind )
+			{
+				if( 'M' == cKind && 2 == sscanf( pcLine, " M %lu %7s", &ulMode, pcName ) && ulMode < schedMAX_NUMBER_OF_MODES )
+				{
+					/* The scheduler keeps the pointer. */
+					vSchedulerModeCreate( ulMode, strdup( pcName ) );
+					continue;
+				}
+				if( 'S' == cKind && 5 == sscanf( pcLine, " S %lu %7s %lu %lu %lu", &ulMode, pcName, &ulPeriod, &ulDeadline, &ulWCET ) &&
+						ulMode < schedMAX_NUMBER_OF_MODES )
+				{
+					#if( schedUSE_POLLING_SERVER == 1 )
+						BaseType_t xServer = prvFindServer( pcName );
+						if( xServer != -1 && ulPeriod > 0 )
+						{
+							vSchedulerModeSetServer( ulMode, xServer, ulPeriod, ulWCET, ulDeadline );
+							continue;
+						}
+					#endif /* schedUSE_POLLING_SERVER */
+					SimJob_t *pxTarget = prvFindPeriodicJob( pcName );
+					if( pxTarget != NULL )
+					{
+						vSchedulerModeSetTask( ulMode, &pxTarget->xHandle, ulPeriod, ulWCET, ulDeadline );
+						continue;
+					}
+				}
+				if( 'C' == cKind && uxChangeCount < simMAX_CHANGES && 2 == sscanf( pcLine, " C %lu %lu", &ulMode, &ulTick ) &&
+						( 0 == uxChangeCount || xChanges[ uxChangeCount - 1 ].xTick <= ulTick ) )
+				{
+					xChanges[ uxChangeCount ].xTick = ulTick;
+					xChanges[ uxChangeCount ].pxJob = NULL;
+					xChanges[ uxChangeCount ].uxMode = ulMode;
+					uxChangeCount++;
+					continue;
+				}
+				fprintf( stderr, "%s:%lu: invalid line, unknown task or tick out of order\n", pcPath, ulLine );
+				fclose( pxFile );
+				return pdFAIL;
+			}
+		#endif /* schedUSE_MODES */
+
+		if( 'D' == cKind || 'E' == cKind )
+		{
+			char pcName[ configMAX_TASK_NAME_LEN ];
+			unsigned long ulTick, ulStackDepth = 0;
+			BaseType_t xFields = sscanf( pcLine, " %*c %7s %lu %lu", pcName, &ulTick, &ulStackDepth );
+			if( uxChangeCount < simMAX_CHANGES && ( 2 == xFields || ( 3 == xFields && 'E' == cKind ) ) &&
+					( xChanges[ uxChangeCount ].pxJob = prvFindPeriodicJob( pcName ) ) != NULL &&
+					( 0 == uxChangeCount || xChanges[ uxChangeCount - 1 ].xTick <= ulTick ) )
+			{
+				xChanges[ uxChangeCount ].xTick = ulTick;
+				xChanges[ uxChangeCount ].xEnable = ( 'E' == cKind ) ? pdTRUE : pdFALSE;
+				xChanges[ uxChangeCount ].usStackDepth = ulStackDepth;
+				uxChangeCount++;
+				continue;
+			}
+			fprintf( stderr, "%s:%lu: invalid line, unknown task or tick out of order\n", pcPath, ulLine );
+			fclose( pxFile );
+			return pdFAIL;
+		}
+
+		#if( schedUSE_RESOURCES == 1 )
+			if( 'R' == cKind || 'U' == cKind )
+			{
+				char pcName[ configMAX_TASK_NAME_LEN ];
+				char pcResource[ configMAX_TASK_NAME_LEN ];
+				unsigned long ulOffset, ulLength;
+				if( 'R' == cKind && uxResourceCount < schedMAX_NUMBER_OF_RESOURCES &&
+						1 == sscanf( pcLine, " R %7s", pcResourceNames[ uxResourceCount ] ) &&
+						xSchedulerResourceCreate( pcResourceNames[ uxResourceCount ] ) != -1 )
+				{
+					uxResourceCount++;
+					continue;
+				}
+				SimJob_t *pxTarget;
+				if( 'U' == cKind && 4 == sscanf( pcLine, " U %7s %7s %lu %lu", pcName, pcResource, &ulOffset, &ulLength ) && ulLength > 0 &&
+						( pxTarget = prvFindPeriodicJob( pcName ) ) != NULL && -1 == pxTarget->xResource )
+				{
+					for( UBaseType_t uxResource = 0; uxResource < uxResourceCount; uxResource++ )
+					{
+						if( 0 == strcmp( pcResourceNames[ uxResource ], pcResource ) )
+						{
+							pxTarget->xResource = uxResource;
+							pxTarget->xSectionOffset = ulOffset;
+							pxTarget->xSectionLength = ulLength;
+							vSchedulerResourceUse( uxResource, &pxTarget->xHandle, ulLength );
+						}
+					}
+					if( pxTarget->xResource != -1 )
+					{
+						continue;
+					}
+				}
+				fprintf( stderr, "%s:%lu: invalid line, unknown task or resource\n", pcPath, ulLine );
+				fclose( pxFile );
+				return pdFAIL;
+			}
+		#endif /* schedUSE_RESOURCES */
+
+		#if( schedUSE_POLLING_SERVER == 1 )
+			if( 'V' == cKind )
+			{
+				if( uxServerCount < schedMAX_NUMBER_OF_SERVERS &&
+						4 == sscanf( pcLine, " V %7s %lu %lu %lu", pcServerNames[ uxServerCount ], &ulPeriod, &ulDeadline, &ulWCET ) &&
+						xSchedulerServerCreate( pcServerNames[ uxServerCount ], ulPeriod, ulWCET, ulDeadline ) != -1 )
+				{
+					uxServerCount++;
+					continue;
+				}
+				fprintf( stderr, "%s:%lu: invalid line or too many servers for this scheduler configuration\n", pcPath, ulLine );
+				fclose( pxFile );
+				return pdFAIL;
+			}
+		#endif /* schedUSE_POLLING_SERVER */
+
+		if( uxJobCount < simMAX_JOBS )
+		{
+			if( 'P' == cKind && uxPeriodicCount < schedMAX_NUMBER_OF_PERIODIC_TASKS &&
+					8 <= sscanf( pcLine, " P %7s %lu %lu %lu %lu %lu %lu %lu %9s", pxJob->pcName, &ulPriority, &ulPhase, &ulPeriod, &ulDeadline, &ulWCET, &ulMin, &ulMax, pcPolicy ) )
+			{
+				while( uxPolicy <= schedMISS_POLICY_CONTINUE && strcmp( pcPolicy, pcMissPolicyNames[ uxPolicy ] ) != 0 )
+				{
+					uxPolicy++;
+				}
+				xValid = ( ulMin <= ulMax && uxPolicy <= schedMISS_POLICY_CONTINUE ) ? pdTRUE : pdFALSE;
+				if( pdTRUE == xValid )
+				{
+					pxJob->xMinExecTime = ulMin;
+					pxJob->xMaxExecTime = ulMax;
+					pxJob->xIsPeriodic = pdTRUE;
+					pxJob->uxPriority = ulPriority;
+					pxJob->uxMissPolicy = uxPolicy;
+					pxJob->xPhase = ulPhase;
+					pxJob->xPeriod = ulPeriod;
+					pxJob->xDeadline = ulDeadline;
+					pxJob->xWCET = ulWCET;
+					pxJob->usStackDepth = configMINIMAL_STACK_SIZE;
+					xValid = ( pdPASS == prvEnablePeriodicJob( pxJob ) ) ? pdTRUE : pdFALSE;
+					uxPeriodicCount++;
+				}
+			}
+			#if( schedUSE_APERIODIC_JOBS == 1 )
+				else if( 'A' == cKind && 5 <= sscanf( pcLine, " A %7s %lu %lu %lu %lu %7s", pxJob->pcName, &ulPhase, &ulWCET, &ulMin, &ulMax, pcServer ) )
+				{
+					BaseType_t xServer = prvFindServer( pcServer );
+					xValid = ( ulMin <= ulMax && xServer != -1 ) ? pdTRUE : pdFALSE;
+					if( pdTRUE == xValid )
+					{
+						pxJob->xMinExecTime = ulMin;
+						pxJob->xMaxExecTime = ulMax;
+						vSchedulerAperiodicTaskCreateOnServer( xServer, prvSimulatedJob, pxJob->pcName, pxJob, ulWCET, ulPhase, 0 );
+					}
+				}
+			#endif /* schedUSE_APERIODIC_JOBS */
+		}
+
+		if( pdFALSE == xValid )
+		{
+			fprintf( stderr, "%s:%lu: invalid line or too many tasks for this scheduler configuration\n", pcPath, ulLine );
+			fclose( pxFile );
+			return pdFAIL;
+		}
+		uxJobCount++;
+	}
+
+	fclose( pxFile );
+	return pdPASS;
+}
+
+#if( schedUSE_TASK_STATISTICS == 1 )
+	static void prvPrintStats( const char *pcName, const SchedTaskStats_t *pxStats )
+	{
+		if( 0 == pxStats->ulJobCount )
+		{
+			fprintf( stderr, "%-8s %8s\n", pcName, "0" );
+			return;
+		}
+		fprintf( stderr, "%-8s %8lu %8lu %8lu %8lu %8lu %8lu %8lu %8lu  ", pcName, ( unsigned long ) pxStats->ulJobCount,
+				( unsigned long ) pxStats->xMinExecTime, ( unsigned long ) pxStats->xMeanExecTime, ( unsigned long ) pxStats->xMaxExecTime,
+				( unsigned long ) pxStats->xMinResponseTime, ( unsigned long ) pxStats->xMeanResponseTime, ( unsigned long ) pxStats->xMaxResponseTime,
+				( unsigned long ) pxStats->xMaxReleaseJitter );
+		for( UBaseType_t uxBucket = 0; uxBucket < schedSTATS_HISTOGRAM_BUCKETS; uxBucket++ )
+		{
+			fprintf( stderr, " %lu", ( unsigned long ) pxStats->ulResponseTimeHistogram[ uxBucket ] );
+		}
+		fprintf( stderr, "\n" );
+	}
+
+	/* Prints what the statistics API of the scheduler reports. */
+	static void prvPrintSchedulerStats( void )
+	{
+		SchedTaskStats_t xStats;
+
+		fprintf( stderr, "%-8s %8s %8s %8s %8s %8s %8s %8s %8s   histogram of response times, %lu ticks per bucket\n", "task", "jobs",
+				"cmin", "cmean", "cmax", "rmin", "rmean", "rmax", "jitter", ( unsigned long ) schedSTATS_HISTOGRAM_BUCKET_WIDTH );
+		/* Statistics of a deleted task are gone. */
+		for( UBaseType_t uxIndex = 0; uxIndex < uxJobCount; uxIndex++ )
+		{
+			/* Tasks outside the current mode have no handle. */
+			if( pdTRUE == xJobs[ uxIndex ].xEnabled && xJobs[ uxIndex ].xHandle != NULL && pdPASS == xSchedulerGetTaskStats( xJobs[ uxIndex ].xHandle, &xStats ) )
+			{
+				prvPrintStats( xJobs[ uxIndex ].pcName, &xStats );
+			}
+		}
+		#if( schedUSE_POLLING_SERVER == 1 )
+			for( UBaseType_t uxServer = 0; uxServer < uxServerCount; uxServer++ )
+			{
+				vSchedulerGetServerStats( uxServer, &xStats );
+				prvPrintStats( pcServerNames[ uxServer ], &xStats );
+			}
+		#endif /* schedUSE_POLLING_SERVER */
+		#if( schedUSE_APERIODIC_JOBS == 1 )
+			vSchedulerGetAperiodicStats( &xStats );
+			prvPrintStats( "aperiod.", &xStats );
+		#endif /* schedUSE_APERIODIC_JOBS */
+	}
+#endif /* schedUSE_TASK_STATISTICS */
+
+static void prvPrintSummary( uint32_t ulTicks, BaseType_t xBenchmark )
+{
+	uint32_t ulMisses = 0;
+
+	fprintf( stderr, "%lu ticks simulated\n", ( unsigned long ) ulTicks );
+	fprintf( stderr, "%-8s %8s %8s %8s %8s %8s\n", "task", "start", "end", "miss", "overrun", "abort" );
+	for( UBaseType_t uxIndex = 0; uxIndex < uxJobCount; uxIndex++ )
+	{
+		const uint32_t *pulCount = xJobs[ uxIndex ].ulEventCount;
+		fprintf( stderr, "%-8s %8lu %8lu %8lu %8lu %8lu\n", xJobs[ uxIndex ].pcName, ( unsigned long ) pulCount[ schedTRACE_EVENT_START ],
+				( unsigned long ) pulCount[ schedTRACE_EVENT_END ], ( unsigned long ) pulCount[ schedTRACE_EVENT_MISS ],
+				( unsigned long ) pulCount[ schedTRACE_EVENT_OVERRUN ], ( unsigned long ) pulCount[ schedTRACE_EVENT_ABORT ] );
+		ulMisses += pulCount[ schedTRACE_EVENT_MISS ];
+	}
+	fprintf( stderr, "%lu deadline misses\n", ( unsigned long ) ulMisses );
+	uint32_t ulPreemptions;
+	uint32_t ulSwitches = ulSimulatorContextSwitches( &ulPreemptions );
+	fprintf( stderr, "%lu context switches, %lu preemptions\n", ( unsigned long ) ulSwitches, ( unsigned long ) ulPreemptions );
+	if( pdTRUE == xBenchmark )
+	{
+		fprintf( stderr, "%lu ns per tick hook on the host\n", ( unsigned long ) ulSimulatorTickHookNs() );
+		uint32_t ulHostUs;
+		uint32_t ulActivations = ulSimulatorTaskActivations( "Scheduler", &ulHostUs );
+		fprintf( stderr, "%lu scheduler task activations, %lu us on the host\n", ( unsigned long ) ulActivations, ( unsigned long ) ulHostUs );
+	}
+	#if( schedUSE_PREEMPTION_THRESHOLDS == 1 )
+		fprintf( stderr, "%lu words of shared stack\n", ( unsigned long ) ulSchedulerGetSharedStackDepth() );
+	#endif /* schedUSE_PREEMPTION_THRESHOLDS */
+	#if( schedUSE_MODES == 1 )
+		fprintf( stderr, "mode %lu %s\n", ( unsigned long ) uxSchedulerGetMode(), pcSchedulerGetModeName( uxSchedulerGetMode() ) );
+	#endif /* schedUSE_MODES */
+
+	#if( schedUSE_TASK_STATISTICS == 1 )
+		prvPrintSchedulerStats();
+	#endif /* schedUSE_TASK_STATISTICS */
+
+	#if( schedUSE_STACK_PROFILING == 1 )
+		SchedStackUsage_t xUsage;
+		fprintf( stderr, "%-10s %8s %8s %12s   stack in words, measured on the host\n", "task", "size", "used", "recommended" );
+		for( UBaseType_t uxIndex = 0; pdPASS == xSchedulerGetStackUsage( uxIndex, &xUsage ); uxIndex++ )
+		{
+			fprintf( stderr, "%-10s %8u %8u %12u\n", xUsage.pcName, ( unsigned ) xUsage.usStackDepth, ( unsigned ) xUsage.usMaxUsed,
+					( unsigned ) xUsage.usRecommendedDepth );
+		}
+	#endif /* schedUSE_STACK_PROFILING */
+}
+
+int main( int argc, char **argv )
+{
+	unsigned long ulSeed = 1;
+	unsigned long ulTicks = 3600UL * configTICK_RATE_HZ;
+	BaseType_t xBenchmark = pdFALSE;
+	int iOption;
+
+	while( ( iOption = getopt( argc, argv, "s:t:vb" ) ) != -1 )
+	{
+		switch( iOption )
+		{
+			case 's':
+				ulSeed = strtoul( optarg, NULL, 0 );
+				break;
+			case 't':
+				ulTicks = strtoul( optarg, NULL, 0 );
+				break;
+			case 'v':
+				vSimulatorSetSerialEcho( pdTRUE );
+				break;
+			case 'b':
+				xBenchmark = pdTRUE;
+				break;
+			default:
+				optind = argc;
+				break;
+		}
+	}
+	if( optind != argc - 1 )
+	{
+		fprintf( stderr, "usage: %s [-s seed] [-t ticks] [-v] [-b] taskset\n", argv[ 0 ] );
+		return 2;
+	}
+
+	/* xorshift must not start from zero. */
+	ullRandomState = ( ( uint64_t ) ulSeed << 1 ) | 1;
+
+	vSchedulerInit();
+	if( pdFAIL == prvLoadTaskSet( argv[ optind ] ) )
+	{
+		return 2;
+	}
+
+	if( uxChangeCount > 0 )
+	{
+		xTaskCreate( prvTaskSetControl, "Control", simCONTROL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL );
+	}
+
+	vSimulatorSetHorizon( ulTicks );
+	vSchedulerStart();
+
+	fflush( stdout );
+	prvPrintSummary( ulTicks, xBenchmark );
+	return 0;
+}
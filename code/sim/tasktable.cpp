@@ -0,0 +1,172 @@
+/* Compares the task tables of scheduler.h with scheduler.cpp.
+ *
+ * Usage: tasktable projectf|shared|overload
+ *
+ * The compiler computes the priorities and response times of a task table
+ * with its own copy of prvSetFixedPriorities and the response time analysis.
+ * For each task set below this creates the same tasks with
+ * xSchedulerPeriodicTaskCreate, lets vSchedulerStart assign them on the
+ * simulated kernel and compares both, one line per task. Exits with 1 if any
+ * task differs. The static_asserts pin the tables of the default
+ * configuration, so a change of either copy shows up here. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scheduler.h"
+
+#if( schedUSE_TASK_TABLE == 1 )
+
+/* Jobs take no time, only the analysis matters. */
+static void prvJob( void *pvParameters )
+{
+	( void ) pvParameters;
+}
+
+static TaskHandle_t xHandles[ 5 ];
+
+/* The task set of ProjectF.ino, T2 has the shorter deadline. */
+static constexpr SchedTaskSpec_t xProjectF[] = {
+	{ prvJob, "T1", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 0 ], 0, 124, 27, 124, schedMISS_POLICY_ABORT_JOB },
+	{ prvJob, "T2", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 1 ], 6, 248, 27, 62, schedMISS_POLICY_ABORT_JOB }
+};
+static constexpr auto xProjectFTable = xSchedulerTaskTableBuild( xProjectF );
+
+/* More tasks than priorities, so the server, S3 and S4 share the lowest
+ * one. S2 and S5 have the same period and keep their order. */
+static constexpr SchedTaskSpec_t xShared[] = {
+	{ prvJob, "S4", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 0 ], 0, 160, 8, 160, schedMISS_POLICY_ABORT_JOB },
+	{ prvJob, "S1", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 1 ], 0, 20, 3, 20, schedMISS_POLICY_ABORT_JOB },
+	{ prvJob, "S3", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 2 ], 0, 80, 6, 70, schedMISS_POLICY_ABORT_JOB },
+	{ prvJob, "S2", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 3 ], 0, 40, 5, 40, schedMISS_POLICY_ABORT_JOB },
+	{ prvJob, "S5", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 4 ], 0, 40, 1, 40, schedMISS_POLICY_ABORT_JOB }
+};
+static constexpr auto xSharedTable = xSchedulerTaskTableBuild( xShared );
+
+/* O2 can miss its deadline, which is shorter than its period. */
+static constexpr SchedTaskSpec_t xOverload[] = {
+	{ prvJob, "O1", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 0 ], 0, 200, 40, 200, schedMISS_POLICY_ABORT_JOB },
+	{ prvJob, "O2", configMINIMAL_STACK_SIZE, NULL, &xHandles[ 1 ], 0, 300, 100, 150, schedMISS_POLICY_ABORT_JOB }
+};
+static constexpr auto xOverloadTable = xSchedulerTaskTableBuild( xOverload );
+
+/* Returns true if xEntry has the given period, priority and response time. */
+constexpr bool prvRowIs( const SchedTaskTableEntry_t &xEntry, TickType_t xPeriod, UBaseType_t uxPriority, TickType_t xResponseTime )
+{
+	return xEntry.xSpec.xPeriodTick == xPeriod && xEntry.uxPriority == uxPriority && xEntry.xResponseTime == xResponseTime;
+}
+
+#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS && schedUSE_POLLING_SERVER == 1 && schedUSE_DEFERRABLE_SERVER == 0 && \
+		schedPRIORITY_STRIDE == 1 && configMAX_PRIORITIES == 4 )
+	/* The Polling Server has period 62, budget 27 and deadline 31. */
+	static_assert( prvRowIs( xProjectFTable.xEntries[ 0 ], 62, 3, 27 ) && prvRowIs( xProjectFTable.xEntries[ 1 ], 124, 2, 54 ) &&
+			prvRowIs( xProjectFTable.xEntries[ 2 ], 248, 1, portMAX_DELAY ), "ProjectF table changed" );
+	static_assert( prvRowIs( xSharedTable.xEntries[ 0 ], 20, 3, 3 ) && prvRowIs( xSharedTable.xEntries[ 1 ], 40, 2, 8 ) &&
+			prvRowIs( xSharedTable.xEntries[ 2 ], 40, 1, 9 ) && prvRowIs( xSharedTable.xEntries[ 3 ], 62, 0, portMAX_DELAY ) &&
+			prvRowIs( xSharedTable.xEntries[ 4 ], 80, 0, portMAX_DELAY ) && prvRowIs( xSharedTable.xEntries[ 5 ], 160, 0, 110 ), "Shared table changed" );
+	static_assert( prvRowIs( xOverloadTable.xEntries[ 0 ], 62, 3, 27 ) && prvRowIs( xOverloadTable.xEntries[ 1 ], 200, 2, 94 ) &&
+			prvRowIs( xOverloadTable.xEntries[ 2 ], 300, 1, portMAX_DELAY ), "Overload table changed" );
+#endif /* schedSCHEDULING_POLICY */
+
+/* The table under test, for the check task. */
+static const SchedTaskTableEntry_t *pxCheckEntries;
+static UBaseType_t uxCheckCount;
+static UBaseType_t uxDifferences = 0;
+
+/* Runs once the scheduler has created the tasks and compares every row
+ * that is not a server. */
+static void prvCheckTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for( UBaseType_t uxIndex = 0; uxIndex < uxCheckCount; uxIndex++ )
+	{
+		const SchedTaskTableEntry_t *pxEntry = &pxCheckEntries[ uxIndex ];
+		if( NULL == pxEntry->xSpec.pvTaskCode )
+		{
+			continue;
+		}
+		TaskHandle_t xHandle = *pxEntry->xSpec.pxCreatedTask;
+		UBaseType_t uxPriority = uxTaskPriorityGet( xHandle );
+		TickType_t xResponseTime = xSchedulerPeriodicTaskResponseTime( xHandle );
+		BaseType_t xSame = ( uxPriority == pxEntry->uxPriority && xResponseTime == pxEntry->xResponseTime ) ? pdTRUE : pdFALSE;
+		printf( "%-7s priority %u table %u, response time %ld table %ld%s\n", pxEntry->xSpec.pcName, ( unsigned ) uxPriority,
+				( unsigned ) pxEntry->uxPriority, ( portMAX_DELAY == xResponseTime ) ? -1L : ( long ) xResponseTime,
+				( portMAX_DELAY == pxEntry->xResponseTime ) ? -1L : ( long ) pxEntry->xResponseTime, ( pdTRUE == xSame ) ? "" : "  DIFFERENT" );
+		if( pdFALSE == xSame )
+		{
+			uxDifferences++;
+		}
+	}
+	vTaskDelete( NULL );
+}
+
+/* Creates the task set at run time and compares it with its table. */
+template< size_t N >
+static void prvCompare( const char *pcName, const SchedTaskSpec_t ( &xSpecs )[ N ], const SchedTaskTable< N > &xTable )
+{
+	printf( "%s\n", pcName );
+	vSchedulerInit();
+	for( size_t uxIndex = 0; uxIndex < N; uxIndex++ )
+	{
+		const SchedTaskSpec_t *pxSpec = &xSpecs[ uxIndex ];
+		if( pdFAIL == xSchedulerPeriodicTaskCreate( pxSpec->pvTaskCode, pxSpec->pcName, pxSpec->usStackDepth, pxSpec->pvParameters, 0,
+				pxSpec->pxCreatedTask, pxSpec->xPhaseTick, pxSpec->xPeriodTick, pxSpec->xMaxExecTimeTick, pxSpec->xDeadlineTick, pxSpec->uxMissPolicy ) )
+		{
+			printf( "%s could not be created\n", pxSpec->pcName );
+			exit( 1 );
+		}
+	}
+	pxCheckEntries = xTable.xEntries;
+	uxCheckCount = N + schedTASK_TABLE_SERVER_ROWS;
+	xTaskCreate( prvCheckTask, "Check", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL );
+	vSimulatorSetHorizon( 1 );
+	vSchedulerStart();
+}
+
+void vSimulatorTraceEvent( uint8_t ucEvent, const char *pcName, TickType_t xTick )
+{
+	( void ) ucEvent;
+	( void ) pcName;
+	( void ) xTick;
+}
+
+int main( int argc, char **argv )
+{
+	if( argc != 2 )
+	{
+		fprintf( stderr, "usage: %s projectf|shared|overload\n", argv[ 0 ] );
+		return 2;
+	}
+
+	/* The scheduler runs once per process. */
+	if( 0 == strcmp( argv[ 1 ], "projectf" ) )
+	{
+		prvCompare( argv[ 1 ], xProjectF, xProjectFTable );
+	}
+	else if( 0 == strcmp( argv[ 1 ], "shared" ) )
+	{
+		prvCompare( argv[ 1 ], xShared, xSharedTable );
+	}
+	else if( 0 == strcmp( argv[ 1 ], "overload" ) )
+	{
+		prvCompare( argv[ 1 ], xOverload, xOverloadTable );
+	}
+	else
+	{
+		fprintf( stderr, "unknown task set %s\n", argv[ 1 ] );
+		return 2;
+	}
+	return ( uxDifferences > 0 ) ? 1 : 0;
+}
+
+#else
+
+int main( void )
+{
+	fprintf( stderr, "task tables need schedUSE_TASK_TABLE\n" );
+	return 2;
+}
+
+#endif /* schedUSE_TASK_TABLE */